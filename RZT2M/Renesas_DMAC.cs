@@ -0,0 +1,334 @@
+//
+// Copyright (c) 2010-2023 Antmicro
+//
+// This file is licensed under the MIT License.
+// Full license text is available in 'licenses/MIT.txt'.
+//
+using System;
+using Antmicro.Renode.Core;
+using Antmicro.Renode.Core.Structure.Registers;
+using Antmicro.Renode.Logging;
+using Antmicro.Renode.Peripherals.Bus;
+using Antmicro.Renode.Peripherals.UART;
+
+namespace Antmicro.Renode.Peripherals.DMA
+{
+    // Simplified DMAC: register names follow the RZ/T2M DMAC, but only single-block
+    // byte transfers are modelled. Inputs 2n and 2n + 1 are the RX and TX DMA requests
+    // of SCIn (raised only while routed here, see Renesas_SCI.ReceiveDmaSelect); a
+    // channel selects one of them in CHCFG.REQSEL, higher values start
+    // a memory-to-memory transfer on SETEN. When the fixed side of a transfer is
+    // a Renesas_SCI data register the block goes straight to its fifos.
+    public class Renesas_DMAC : IDoubleWordPeripheral, IProvidesRegisterCollection<DoubleWordRegisterCollection>, IGPIOReceiver, IKnownSize
+    {
+        public Renesas_DMAC(IMachine machine)
+        {
+            sysbus = machine.SystemBus;
+            RegistersCollection = new DoubleWordRegisterCollection(this);
+            channels = new Channel[NumberOfChannels];
+            for(var i = 0; i < NumberOfChannels; i++)
+            {
+                channels[i] = new Channel();
+            }
+            requests = new bool[NumberOfRequests];
+            pendingRequests = new bool[NumberOfRequests];
+
+            DefineRegisters();
+        }
+
+        public uint ReadDoubleWord(long offset)
+        {
+            return RegistersCollection.Read(offset);
+        }
+
+        public void WriteDoubleWord(long offset, uint value)
+        {
+            RegistersCollection.Write(offset, value);
+        }
+
+        public void OnGPIO(int number, bool value)
+        {
+            if(number < 0 || number >= NumberOfRequests)
+            {
+                this.Log(LogLevel.Warning, "Unexpected DMA request input: {0}", number);
+                return;
+            }
+            // pulsed requests (SCI TX in instant mode) are latched until a block is moved
+            if(value && !requests[number])
+            {
+                pendingRequests[number] = true;
+            }
+            requests[number] = value;
+            if(!value)
+            {
+                return;
+            }
+            for(var i = 0; i < NumberOfChannels; i++)
+            {
+                if(channels[i].Enabled && (int)channels[i].RequestSelect.Value == number)
+                {
+                    Service(i);
+                }
+            }
+        }
+
+        public void Reset()
+        {
+            RegistersCollection.Reset();
+            foreach(var channel in channels)
+            {
+                channel.Reset();
+            }
+            Array.Clear(requests, 0, requests.Length);
+            Array.Clear(pendingRequests, 0, pendingRequests.Length);
+            IRQ.Unset();
+        }
+
+        public DoubleWordRegisterCollection RegistersCollection { get; }
+
+        public long Size => 0x1000;
+
+        // channel transfer end, shared by all channels
+        public GPIO IRQ { get; } = new GPIO();
+
+        private void DefineRegisters()
+        {
+            Registers.NextSourceAddress.DefineMany(this, NumberOfChannels, (register, idx) =>
+                register.WithValueField(0, 32, name: "SA",
+                    valueProviderCallback: _ => channels[idx].SourceAddress,
+                    writeCallback: (_, value) => channels[idx].SourceAddress = (uint)value), stepInBytes: ChannelStride);
+
+            Registers.NextDestinationAddress.DefineMany(this, NumberOfChannels, (register, idx) =>
+                register.WithValueField(0, 32, name: "DA",
+                    valueProviderCallback: _ => channels[idx].DestinationAddress,
+                    writeCallback: (_, value) => channels[idx].DestinationAddress = (uint)value), stepInBytes: ChannelStride);
+
+            Registers.NextTransactionByte.DefineMany(this, NumberOfChannels, (register, idx) =>
+                register.WithValueField(0, 32, name: "TB",
+                    valueProviderCallback: _ => channels[idx].TransferBytes,
+                    writeCallback: (_, value) => channels[idx].TransferBytes = (uint)value), stepInBytes: ChannelStride);
+
+            Registers.CurrentTransactionByte.DefineMany(this, NumberOfChannels, (register, idx) =>
+                register.WithValueField(0, 32, FieldMode.Read, name: "CRTB",
+                    valueProviderCallback: _ => channels[idx].RemainingBytes), stepInBytes: ChannelStride);
+
+            Registers.ChannelStatus.DefineMany(this, NumberOfChannels, (register, idx) =>
+                register
+                    .WithFlag(0, FieldMode.Read, name: "EN", valueProviderCallback: _ => channels[idx].Enabled)
+                    .WithReservedBits(1, 4)
+                    .WithFlag(5, FieldMode.Read, name: "END", valueProviderCallback: _ => channels[idx].Ended)
+                    .WithReservedBits(6, 26), stepInBytes: ChannelStride);
+
+            Registers.ChannelControl.DefineMany(this, NumberOfChannels, (register, idx) =>
+                register
+                    .WithFlag(0, FieldMode.Write, name: "SETEN", writeCallback: (_, value) => { if(value) StartChannel(idx); })
+                    .WithFlag(1, FieldMode.Write, name: "CLREN", writeCallback: (_, value) => { if(value) channels[idx].Enabled = false; })
+                    .WithReservedBits(2, 3)
+                    .WithFlag(5, FieldMode.Write, name: "CLREND",
+                        writeCallback: (_, value) =>
+                        {
+                            if(value)
+                            {
+                                channels[idx].Ended = false;
+                                UpdateInterrupts();
+                            }
+                        })
+                    .WithReservedBits(6, 26), stepInBytes: ChannelStride);
+
+            Registers.ChannelConfig.DefineMany(this, NumberOfChannels, (register, idx) =>
+                register
+                    .WithValueField(0, 4, out channels[idx].RequestSelect, name: "REQSEL")
+                    .WithReservedBits(4, 16)
+                    .WithFlag(20, out channels[idx].SourceFixed, name: "SAD")
+                    .WithFlag(21, out channels[idx].DestinationFixed, name: "DAD")
+                    .WithReservedBits(22, 2)
+                    .WithFlag(24, out channels[idx].EndInterruptMask, name: "DEM",
+                        writeCallback: (_, __) => UpdateInterrupts())
+                    .WithReservedBits(25, 7), stepInBytes: ChannelStride);
+        }
+
+        private void StartChannel(int idx)
+        {
+            var channel = channels[idx];
+            channel.Enabled = true;
+            channel.Ended = false;
+            channel.CurrentSource = channel.SourceAddress;
+            channel.CurrentDestination = channel.DestinationAddress;
+            channel.RemainingBytes = channel.TransferBytes;
+            UpdateInterrupts();
+
+            // memory-to-memory channels and already pending requests start right away
+            if(IsRequested((int)channel.RequestSelect.Value))
+            {
+                Service(idx);
+            }
+        }
+
+        private void Service(int idx)
+        {
+            var channel = channels[idx];
+            // the SCI re-evaluates its request lines from inside a block transfer
+            if(channel.Busy)
+            {
+                return;
+            }
+            channel.Busy = true;
+            try
+            {
+                var request = (int)channel.RequestSelect.Value;
+                while(channel.Enabled && channel.RemainingBytes > 0 && IsRequested(request))
+                {
+                    if(request < NumberOfRequests)
+                    {
+                        pendingRequests[request] = false;
+                    }
+                    if(TransferBlock(channel) == 0)
+                    {
+                        break;
+                    }
+                }
+                if(channel.Enabled && channel.RemainingBytes == 0)
+                {
+                    channel.Enabled = false;
+                    channel.Ended = true;
+                    UpdateInterrupts();
+                }
+            }
+            finally
+            {
+                channel.Busy = false;
+            }
+        }
+
+        private bool IsRequested(int request)
+        {
+            return request >= NumberOfRequests || requests[request] || pendingRequests[request];
+        }
+
+        private int TransferBlock(Channel channel)
+        {
+            var count = (int)Math.Min(channel.RemainingBytes, (uint)buffer.Length);
+            int moved;
+
+            if(channel.SourceFixed.Value && sysbus.WhatPeripheralIsAt(channel.CurrentSource) is Renesas_SCI receiver)
+            {
+                moved = receiver.ReadReceiveBlock(buffer, 0, count);
+                WriteToDestination(channel, moved);
+            }
+            else if(channel.DestinationFixed.Value && sysbus.WhatPeripheralIsAt(channel.CurrentDestination) is Renesas_SCI transmitter)
+            {
+                ReadFromSource(channel, count);
+                moved = transmitter.WriteTransmitBlock(buffer, 0, count);
+            }
+            else
+            {
+                ReadFromSource(channel, count);
+                WriteToDestination(channel, count);
+                moved = count;
+            }
+
+            if(!channel.SourceFixed.Value)
+            {
+                channel.CurrentSource += (uint)moved;
+            }
+            if(!channel.DestinationFixed.Value)
+            {
+                channel.CurrentDestination += (uint)moved;
+            }
+            channel.RemainingBytes -= (uint)moved;
+            return moved;
+        }
+
+        private void ReadFromSource(Channel channel, int count)
+        {
+            if(channel.SourceFixed.Value)
+            {
+                for(var i = 0; i < count; i++)
+                {
+                    buffer[i] = sysbus.ReadByte(channel.CurrentSource);
+                }
+                return;
+            }
+            var data = sysbus.ReadBytes(channel.CurrentSource, count);
+            Array.Copy(data, buffer, count);
+        }
+
+        private void WriteToDestination(Channel channel, int count)
+        {
+            if(channel.DestinationFixed.Value)
+            {
+                for(var i = 0; i < count; i++)
+                {
+                    sysbus.WriteByte(channel.CurrentDestination, buffer[i]);
+                }
+                return;
+            }
+            sysbus.WriteBytes(buffer, channel.CurrentDestination, 0, count);
+        }
+
+        private void UpdateInterrupts()
+        {
+            var state = false;
+            foreach(var channel in channels)
+            {
+                state |= channel.Ended && !channel.EndInterruptMask.Value;
+            }
+            IRQ.Set(state);
+        }
+
+        private readonly IBusController sysbus;
+        private readonly Channel[] channels;
+        private readonly bool[] requests;
+        private readonly bool[] pendingRequests;
+        private readonly byte[] buffer = new byte[BlockSize];
+
+        private const int NumberOfChannels = 8;
+        // RX and TX request of sci0..sci5
+        private const int NumberOfRequests = 12;
+        private const int ChannelStride = 0x40;
+        // largest chunk moved per bus access
+        private const int BlockSize = 256;
+
+        private class Channel
+        {
+            public void Reset()
+            {
+                SourceAddress = 0;
+                DestinationAddress = 0;
+                TransferBytes = 0;
+                CurrentSource = 0;
+                CurrentDestination = 0;
+                RemainingBytes = 0;
+                Enabled = false;
+                Ended = false;
+                Busy = false;
+            }
+
+            public uint SourceAddress;
+            public uint DestinationAddress;
+            public uint TransferBytes;
+            public uint CurrentSource;
+            public uint CurrentDestination;
+            public uint RemainingBytes;
+            public bool Enabled;
+            public bool Ended;
+            public bool Busy;
+
+            public IValueRegisterField RequestSelect;
+            public IFlagRegisterField SourceFixed;
+            public IFlagRegisterField DestinationFixed;
+            public IFlagRegisterField EndInterruptMask;
+        }
+
+        private enum Registers
+        {
+            NextSourceAddress = 0x00, // N0SA
+            NextDestinationAddress = 0x04, // N0DA
+            NextTransactionByte = 0x08, // N0TB
+            CurrentTransactionByte = 0x20, // CRTB
+            ChannelStatus = 0x24, // CHSTAT
+            ChannelControl = 0x28, // CHCTRL
+            ChannelConfig = 0x2C, // CHCFG
+        }
+    }
+}
@@ -4,105 +4,507 @@ using Antmicro.Renode.Core;
 using Antmicro.Renode.Core.Structure.Registers;
 using Antmicro.Renode.Peripherals.Bus;
 using Antmicro.Renode.Logging;
+using Antmicro.Renode.Utilities;
 
 namespace Antmicro.Renode.Peripherals.GPIOPort
 {
-    public class Renesas_GPIO : BaseGPIOPort, IBytePeripheral, IWordPeripheral, IKnownSize
+    public class Renesas_GPIO : BaseGPIOPort, IBytePeripheral, IWordPeripheral, IDoubleWordPeripheral, IKnownSize
     {
         public Renesas_GPIO(Machine machine) : base(machine, NumberOfPorts * NumberOfPinsPerPort)
         {
             portMode = new IEnumRegisterField<Mode>[NumberOfPorts][];
+            risingEdgeEnable = new IValueRegisterField[NumberOfPorts];
+            fallingEdgeEnable = new IValueRegisterField[NumberOfPorts];
 
             DefineRegisters();
+            ResetRegionSelect();
         }
 
         public byte ReadByte(long offset)
         {
-            return byteRegisters.Read(offset);
+            return ReadByte(offset, Region.NonSafety);
         }
 
         public void WriteByte(long offset, byte value)
         {
-            byteRegisters.Write(offset, value);
+            WriteByte(offset, value, Region.NonSafety);
         }
 
         public ushort ReadWord(long offset)
         {
-            return wordRegisters.Read(offset);
+            return ReadWord(offset, Region.NonSafety);
         }
 
         public void WriteWord(long offset, ushort value)
         {
-            wordRegisters.Write(offset, value);
+            WriteWord(offset, value, Region.NonSafety);
+        }
+
+        public uint ReadDoubleWord(long offset)
+        {
+            return ReadDoubleWord(offset, Region.NonSafety);
+        }
+
+        public void WriteDoubleWord(long offset, uint value)
+        {
+            WriteDoubleWord(offset, value, Region.NonSafety);
+        }
+
+        // Safety region mirror, registered with `region: "safety"` in the platform description
+        [ConnectionRegion("safety")]
+        public byte ReadByteFromSafety(long offset)
+        {
+            return ReadByte(offset, Region.Safety);
+        }
+
+        [ConnectionRegion("safety")]
+        public void WriteByteToSafety(long offset, byte value)
+        {
+            WriteByte(offset, value, Region.Safety);
+        }
+
+        [ConnectionRegion("safety")]
+        public ushort ReadWordFromSafety(long offset)
+        {
+            return ReadWord(offset, Region.Safety);
+        }
+
+        [ConnectionRegion("safety")]
+        public void WriteWordToSafety(long offset, ushort value)
+        {
+            WriteWord(offset, value, Region.Safety);
+        }
+
+        [ConnectionRegion("safety")]
+        public uint ReadDoubleWordFromSafety(long offset)
+        {
+            return ReadDoubleWord(offset, Region.Safety);
+        }
+
+        [ConnectionRegion("safety")]
+        public void WriteDoubleWordToSafety(long offset, uint value)
+        {
+            WriteDoubleWord(offset, value, Region.Safety);
+        }
+
+        // Whole-port access as a bitmask, pin n of the port is bit n. Writes go through the
+        // RSELPm ownership check like a Pm write from the non-safety (or safety) region.
+        public byte ReadPortMask(int port)
+        {
+            if(!IsValidPort(port))
+            {
+                this.Log(LogLevel.Warning, "Unhandled mask read from port {0}", port);
+                return 0;
+            }
+            return ReadPort(port);
+        }
+
+        public void WritePortMask(int port, byte value, bool fromSafetyRegion = false)
+        {
+            if(!IsValidPort(port))
+            {
+                this.Log(LogLevel.Warning, "Unhandled mask write to port {0}, value 0x{1:X}", port, value);
+                return;
+            }
+            WritePort(port, value, fromSafetyRegion ? Region.Safety : Region.NonSafety);
         }
 
         public override void Reset()
         {
             base.Reset();
-            byteRegisters.Reset();
-            wordRegisters.Reset();
+            foreach(var register in byteRegisterTable)
+            {
+                register?.Reset();
+            }
+            foreach(var register in wordRegisterTable)
+            {
+                register.Reset();
+            }
+            Array.Clear(portOutput, 0, portOutput.Length);
+            Array.Clear(drivenLevel, 0, drivenLevel.Length);
+            Array.Clear(inputLevel, 0, inputLevel.Length);
+            Array.Clear(outputEnabled, 0, outputEnabled.Length);
+            Array.Clear(inputEnabled, 0, inputEnabled.Length);
+            Array.Clear(interruptStatus, 0, interruptStatus.Length);
+            ResetRegionSelect();
+            IRQ.Unset();
+            PortWritesReceived = 0;
+            EdgesEmitted = 0;
+            WrongRegionWrites = 0;
+        }
+
+        // Pm writes received from software versus level changes actually driven
+        // onto Connections (and so onto GPIOConnector links).
+        public ulong PortWritesReceived { get; private set; }
+        public ulong PinWritesReceived => PortWritesReceived * NumberOfPinsPerPort;
+        public ulong EdgesEmitted { get; private set; }
+
+        // Byte and word registers are looked up in flat offset-indexed tables; when cleared,
+        // in offset-keyed dictionaries as the generic register collections do. Kept to
+        // compare both, see gpio_register_access_benchmark.resc.
+        public bool FlatRegisterTablesEnabled { get; set; } = true;
+
+        // Pm writes that tried to change pins owned by the other region, see RSELPm
+        public ulong WrongRegionWrites { get; private set; }
+        public bool LogWrongRegionWrites { get; set; }
+
+        // Levels driven from outside (e.g. by a GPIOConnector) are sampled
+        // by pins in Input or OutputInputBuffer mode.
+        public override void OnGPIO(int number, bool value)
+        {
+            base.OnGPIO(number, value);
+            if(number < 0 || number >= NumberOfPorts * NumberOfPinsPerPort)
+            {
+                return;
+            }
+
+            var port = number / NumberOfPinsPerPort;
+            var mask = (byte)(1 << (number % NumberOfPinsPerPort));
+            if(((inputLevel[port] & mask) != 0) == value)
+            {
+                return;
+            }
+            inputLevel[port] = (byte)(value ? inputLevel[port] | mask : inputLevel[port] & ~mask);
+
+            if((inputEnabled[port] & mask) == 0)
+            {
+                return;
+            }
+            var edgeEnable = value ? risingEdgeEnable[port].Value : fallingEdgeEnable[port].Value;
+            if((edgeEnable & mask) != 0)
+            {
+                interruptStatus[port] |= mask;
+                UpdateInterrupt();
+            }
         }
 
+        // Edge-detect interrupt of all ports, see the PortInterrupt* registers
+        public GPIO IRQ { get; } = new GPIO();
+
         public long Size => 0x10000;
 
         private void DefineRegisters()
         {
-            var byteRegistersMap = new Dictionary <long, ByteRegister>();
-            var wordRegistersMap = new Dictionary <long, WordRegister>();
-
+            // Pm registers are served directly from portOutput, see ReadPort/WritePort
             for(int i = 0; i < NumberOfPorts; i++)
             {
-                byteRegistersMap[(long)Registers.Port + i] = new ByteRegister(this)
-                    .WithEnumFields<ByteRegister, byte>(0, 1, NumberOfPinsPerPort, name: "Pm",
-                        valueProviderCallback: CreatePortRegisterValueProviderCallback(i),
-                        writeCallback: CreatePortRegisterWriteCallback(i)
-                    );
-
                 // these registers are necessary to allow software read back the previously written value
-                byteRegistersMap[(long)Registers.PortModeControl + i] = new ByteRegister(this)
+                byteRegisterTable[(long)Registers.PortModeControl + i] = new ByteRegister(this)
                     .WithEnumFields<ByteRegister, byte>(0, 1, NumberOfPinsPerPort, name: "PMCm");
-                byteRegistersMap[(long)Registers.PortRegionSelect + i] = new ByteRegister(this)
-                    .WithEnumFields<ByteRegister, byte>(0, 1, NumberOfPinsPerPort, name: "RSELPm");
+                var port = i;
+                // bit n set: pin n is driven from the non-safety region, cleared: from the safety region;
+                // the register itself is only visible in the safety region (PTADR)
+                byteRegisterTable[(long)Registers.PortRegionSelect + i] = new ByteRegister(this)
+                    .WithValueField(0, 8, name: "RSELPm",
+                        valueProviderCallback: _ => nonSafetyOwned[port],
+                        writeCallback: (_, value) => nonSafetyOwned[port] = (byte)value);
 
-                wordRegistersMap[(long)Registers.PortMode + 0x2 * i] = new WordRegister(this)
+                wordRegisterTable[i] = new WordRegister(this)
                     .WithEnumFields<WordRegister, Mode>(0, 2, NumberOfPinsPerPort, out portMode[i], name: "PMm",
                         writeCallback: CreatePortModeRegisterWriteCallback(i)
                     );
+
+                // not part of the RZ/T2M port block (pin interrupts go through the ICU there),
+                // the model provides per-pin edge detection instead
+                byteRegisterTable[(long)Registers.PortInterruptRisingEnable + i] = new ByteRegister(this)
+                    .WithValueField(0, 8, out risingEdgeEnable[i], name: "PIREm");
+                byteRegisterTable[(long)Registers.PortInterruptFallingEnable + i] = new ByteRegister(this)
+                    .WithValueField(0, 8, out fallingEdgeEnable[i], name: "PIFEm");
+                byteRegisterTable[(long)Registers.PortInterruptStatus + i] = new ByteRegister(this)
+                    .WithValueField(0, 8, name: "PISTm",
+                        valueProviderCallback: _ => interruptStatus[port],
+                        writeCallback: (_, value) =>
+                        {
+                            // write 1 to clear
+                            interruptStatus[port] &= (byte)~value;
+                            UpdateInterrupt();
+                        });
             }
 
-            byteRegisters = new ByteRegisterCollection(this, byteRegistersMap);
-            wordRegisters = new WordRegisterCollection(this, wordRegistersMap);
+            for(var offset = 0; offset < byteRegisterTable.Length; offset++)
+            {
+                if(byteRegisterTable[offset] != null)
+                {
+                    byteRegisterMap[offset] = byteRegisterTable[offset];
+                }
+            }
+            for(var i = 0; i < NumberOfPorts; i++)
+            {
+                wordRegisterMap[(long)Registers.PortMode + 2 * i] = wordRegisterTable[i];
+            }
         }
 
-        private Func<int, byte, byte> CreatePortRegisterValueProviderCallback(int port)
+        // Byte registers are looked up directly by offset, PMm by port index;
+        // both tables are sparse, unused slots are null.
+        private ByteRegister FindByteRegister(long offset, Region region)
         {
-            return (idx, _) => Connections[port * NumberOfPinsPerPort + idx].IsSet ? (byte)1 : (byte)0;
+            if(region == Region.NonSafety && offset >= (long)Registers.PortRegionSelect
+               && offset < (long)Registers.PortRegionSelect + NumberOfPorts)
+            {
+                return null;
+            }
+            if(!FlatRegisterTablesEnabled)
+            {
+                return byteRegisterMap.TryGetValue(offset, out var mapped) ? mapped : null;
+            }
+            return offset >= 0 && offset < byteRegisterTable.Length ? byteRegisterTable[offset] : null;
         }
 
-        private Action<int, byte, byte> CreatePortRegisterWriteCallback(int port)
+        private WordRegister FindWordRegister(long offset)
         {
-            return (idx, _, value) => Connections[port * NumberOfPinsPerPort + idx].Set(value == (byte)1);
+            if(!FlatRegisterTablesEnabled)
+            {
+                return wordRegisterMap.TryGetValue(offset, out var mapped) ? mapped : null;
+            }
+            var index = offset - (long)Registers.PortMode;
+            if(index < 0 || (index & 1) != 0 || (index >> 1) >= NumberOfPorts)
+            {
+                return null;
+            }
+            return wordRegisterTable[index >> 1];
         }
 
-        private Action<int, Mode, Mode> CreatePortModeRegisterWriteCallback(int port)
+        private byte ReadByte(long offset, Region region)
         {
-            return (idx, oldValue, newValue) =>
+            if(IsPortRegister(offset))
             {
-                if(newValue != Mode.Output)
+                return ReadPort((int)(offset - (long)Registers.Port));
+            }
+            var register = FindByteRegister(offset, region);
+            if(register == null)
+            {
+                this.Log(LogLevel.Warning, "Unhandled byte read from 0x{0:X} ({1} region)", offset, region);
+                return 0;
+            }
+            return register.Read();
+        }
+
+        private void WriteByte(long offset, byte value, Region region)
+        {
+            if(IsPortRegister(offset))
+            {
+                WritePort((int)(offset - (long)Registers.Port), value, region);
+                return;
+            }
+            var register = FindByteRegister(offset, region);
+            if(register == null)
+            {
+                this.Log(LogLevel.Warning, "Unhandled byte write to 0x{0:X} ({1} region), value 0x{2:X}", offset, region, value);
+                return;
+            }
+            register.Write(offset, value);
+        }
+
+        private ushort ReadWord(long offset, Region region)
+        {
+            if(IsPortRegister(offset))
+            {
+                return (ushort)ReadPorts(offset, 2);
+            }
+            var register = FindWordRegister(offset);
+            if(register == null)
+            {
+                this.Log(LogLevel.Warning, "Unhandled word read from 0x{0:X} ({1} region)", offset, region);
+                return 0;
+            }
+            return register.Read();
+        }
+
+        private void WriteWord(long offset, ushort value, Region region)
+        {
+            if(IsPortRegister(offset))
+            {
+                WritePorts(offset, 2, value, region);
+                return;
+            }
+            var register = FindWordRegister(offset);
+            if(register == null)
+            {
+                this.Log(LogLevel.Warning, "Unhandled word write to 0x{0:X} ({1} region), value 0x{2:X}", offset, region, value);
+                return;
+            }
+            register.Write(offset, value);
+        }
+
+        // 32-bit accesses cover four consecutive Pm registers (or two PMm registers)
+        private uint ReadDoubleWord(long offset, Region region)
+        {
+            if(IsPortRegister(offset))
+            {
+                return ReadPorts(offset, 4);
+            }
+            if(offset >= (long)Registers.PortMode && offset < (long)Registers.PortModeControl)
+            {
+                return (uint)(ReadWord(offset, region) | (ReadWord(offset + 2, region) << 16));
+            }
+            return (uint)(ReadByte(offset, region) | (ReadByte(offset + 1, region) << 8)
+                | (ReadByte(offset + 2, region) << 16) | (ReadByte(offset + 3, region) << 24));
+        }
+
+        private void WriteDoubleWord(long offset, uint value, Region region)
+        {
+            if(IsPortRegister(offset))
+            {
+                WritePorts(offset, 4, value, region);
+                return;
+            }
+            if(offset >= (long)Registers.PortMode && offset < (long)Registers.PortModeControl)
+            {
+                WriteWord(offset, (ushort)value, region);
+                WriteWord(offset + 2, (ushort)(value >> 16), region);
+                return;
+            }
+            for(var i = 0; i < 4; i++)
+            {
+                WriteByte(offset + i, (byte)(value >> (8 * i)), region);
+            }
+        }
+
+        private bool IsPortRegister(long offset)
+        {
+            // accesses wider than a byte may run past the last port, see ReadPorts
+            return offset >= (long)Registers.Port && offset < (long)Registers.Port + NumberOfPorts;
+        }
+
+        private static bool IsValidPort(int port)
+        {
+            return port >= 0 && port < NumberOfPorts;
+        }
+
+        private byte ReadPort(int port)
+        {
+            // output pins read back the latch, input pins the sampled external level,
+            // Hi-Z pins (input buffer disabled) read as 0
+            var outputs = outputEnabled[port];
+            return (byte)((portOutput[port] & outputs) | (inputLevel[port] & inputEnabled[port] & ~outputs));
+        }
+
+        private void WritePort(int port, byte value)
+        {
+            PortWritesReceived++;
+            portOutput[port] = value;
+            DrivePort(port);
+        }
+
+        private void DrivePort(int port)
+        {
+            var level = (byte)(portOutput[port] & outputEnabled[port]);
+            var changed = drivenLevel[port] ^ level;
+            if(changed == 0)
+            {
+                return;
+            }
+            drivenLevel[port] = level;
+
+            // only real edges are propagated, compared against the last driven level
+            var pinBase = port * NumberOfPinsPerPort;
+            for(var pin = 0; changed != 0; pin++, changed >>= 1)
+            {
+                if((changed & 1) != 0)
+                {
+                    EdgesEmitted++;
+                    Connections[pinBase + pin].Set(BitHelper.IsBitSet(level, (byte)pin));
+                }
+            }
+        }
+
+        private uint ReadPorts(long offset, int width)
+        {
+            var first = (int)(offset - (long)Registers.Port);
+            var result = 0u;
+            for(var i = 0; i < width && first + i < NumberOfPorts; i++)
+            {
+                result |= (uint)ReadPort(first + i) << (8 * i);
+            }
+            return result;
+        }
+
+        private void WritePorts(long offset, int width, uint value, Region region)
+        {
+            var first = (int)(offset - (long)Registers.Port);
+            for(var i = 0; i < width && first + i < NumberOfPorts; i++)
+            {
+                WritePort(first + i, (byte)(value >> (8 * i)), region);
+            }
+        }
+
+        // Pins the accessing region does not own keep their latched value
+        private void WritePort(int port, byte value, Region region)
+        {
+            var owned = region == Region.NonSafety ? nonSafetyOwned[port] : (byte)~nonSafetyOwned[port];
+            var blocked = (value ^ portOutput[port]) & ~owned & 0xFF;
+            if(blocked != 0)
+            {
+                WrongRegionWrites++;
+                // rate limited: logs the 1st, 2nd, 4th, 8th... rejected write
+                if(LogWrongRegionWrites && (WrongRegionWrites & (WrongRegionWrites - 1)) == 0)
                 {
-                    this.Log(LogLevel.Warning, "{0:X} - port mode not supported, keeping the previous value: {0:X}", oldValue);
-                    portMode[port][idx].Value = oldValue;
+                    this.Log(LogLevel.Warning, "P{0} write from the {1} region ignored for pins 0x{2:X2} (RSELP{0} = 0x{3:X2}), {4} such writes so far",
+                        port, region, blocked, nonSafetyOwned[port], WrongRegionWrites);
                 }
+                value = (byte)((value & owned) | (portOutput[port] & ~owned));
+            }
+            WritePort(port, value);
+        }
+
+        private Action<int, Mode, Mode> CreatePortModeRegisterWriteCallback(int port)
+        {
+            return (idx, oldValue, newValue) =>
+            {
+                var mask = (byte)(1 << idx);
+                var drives = newValue == Mode.Output || newValue == Mode.OutputInputBuffer;
+                var samples = newValue == Mode.Input || newValue == Mode.OutputInputBuffer;
+                outputEnabled[port] = (byte)(drives ? outputEnabled[port] | mask : outputEnabled[port] & ~mask);
+                inputEnabled[port] = (byte)(samples ? inputEnabled[port] | mask : inputEnabled[port] & ~mask);
+                // a pin leaving output mode releases the line
+                DrivePort(port);
             };
         }
 
+        private void ResetRegionSelect()
+        {
+            // all pins start in the non-safety region
+            for(var port = 0; port < NumberOfPorts; port++)
+            {
+                nonSafetyOwned[port] = 0xFF;
+            }
+        }
+
+        private void UpdateInterrupt()
+        {
+            var pending = false;
+            for(var port = 0; port < NumberOfPorts && !pending; port++)
+            {
+                pending = interruptStatus[port] != 0;
+            }
+            IRQ.Set(pending);
+        }
+
         private const int NumberOfPorts = 25;
         private const int NumberOfPinsPerPort = 8;
+        // covers every byte register up to the model specific PortInterrupt* block
+        private const int ByteRegisterWindow = 0x1000;
 
         private readonly IEnumRegisterField<Mode>[][] portMode;
+        // output latch of every port, bit n is pin n
+        private readonly byte[] portOutput = new byte[NumberOfPorts];
+        // shadow of the levels last driven onto Connections
+        private readonly byte[] drivenLevel = new byte[NumberOfPorts];
+        // packed per-port state, bit n is pin n
+        private readonly byte[] inputLevel = new byte[NumberOfPorts];
+        private readonly byte[] outputEnabled = new byte[NumberOfPorts];
+        private readonly byte[] inputEnabled = new byte[NumberOfPorts];
+        private readonly byte[] interruptStatus = new byte[NumberOfPorts];
+        // per-pin ownership bitmap mirrored by RSELPm
+        private readonly byte[] nonSafetyOwned = new byte[NumberOfPorts];
+        private readonly IValueRegisterField[] risingEdgeEnable;
+        private readonly IValueRegisterField[] fallingEdgeEnable;
 
-        private ByteRegisterCollection byteRegisters;
-        private WordRegisterCollection wordRegisters;
+        private readonly ByteRegister[] byteRegisterTable = new ByteRegister[ByteRegisterWindow];
+        private readonly WordRegister[] wordRegisterTable = new WordRegister[NumberOfPorts];
+        // the same registers, for FlatRegisterTablesEnabled = false
+        private readonly Dictionary<long, ByteRegister> byteRegisterMap = new Dictionary<long, ByteRegister>();
+        private readonly Dictionary<long, WordRegister> wordRegisterMap = new Dictionary<long, WordRegister>();
 
         private enum Mode
         {
@@ -112,12 +514,22 @@ namespace Antmicro.Renode.Peripherals.GPIOPort
             OutputInputBuffer = 0x3,
         }
 
+        private enum Region
+        {
+            NonSafety,
+            Safety,
+        }
+
         private enum Registers
         {
             Port = 0x0,
             PortMode = 0x200,
             PortModeControl = 0x400,
             PortRegionSelect = 0xc00,
+            // model specific, see DefineRegisters
+            PortInterruptRisingEnable = 0xe00,
+            PortInterruptFallingEnable = 0xe20,
+            PortInterruptStatus = 0xe40,
         }
     }
 }
\ No newline at end of file
@@ -0,0 +1,129 @@
+//
+// Copyright (c) 2010-2023 Antmicro
+//
+// This file is licensed under the MIT License.
+// Full license text is available in 'licenses/MIT.txt'.
+//
+using System;
+using Antmicro.Renode.Core;
+using Antmicro.Renode.Core.Structure.Registers;
+using Antmicro.Renode.Logging;
+using Antmicro.Renode.Peripherals.Bus;
+
+namespace Antmicro.Renode.Peripherals.Miscellaneous
+{
+    // Inter-processor doorbells for the dual-core RZ/T2M platform. Not an RZ/T2M block
+    // (the silicon only has software interrupts in the ICU): every core owns a set of
+    // 32 doorbell bits that the other core rings through DBSETn; an enabled pending bit
+    // raises that core's IRQ. Messages themselves live in a shared SRAM window whose
+    // location is reported in WINBASE/WINSIZE, see ipc_ring.h for the firmware side.
+    public class Renesas_IPC : IDoubleWordPeripheral, IProvidesRegisterCollection<DoubleWordRegisterCollection>, IKnownSize
+    {
+        public Renesas_IPC(uint windowAddress = DefaultWindowAddress, uint windowSize = DefaultWindowSize)
+        {
+            this.windowAddress = windowAddress;
+            this.windowSize = windowSize;
+            RegistersCollection = new DoubleWordRegisterCollection(this);
+            pending = new uint[NumberOfCores];
+            enabled = new IValueRegisterField[NumberOfCores];
+            doorbellCount = new ulong[NumberOfCores];
+
+            DefineRegisters();
+        }
+
+        public uint ReadDoubleWord(long offset)
+        {
+            return RegistersCollection.Read(offset);
+        }
+
+        public void WriteDoubleWord(long offset, uint value)
+        {
+            RegistersCollection.Write(offset, value);
+        }
+
+        public void Reset()
+        {
+            RegistersCollection.Reset();
+            Array.Clear(pending, 0, pending.Length);
+            Array.Clear(doorbellCount, 0, doorbellCount.Length);
+            UpdateInterrupts();
+        }
+
+        public DoubleWordRegisterCollection RegistersCollection { get; }
+
+        public long Size => 0x100;
+
+        public GPIO Cpu0IRQ { get; } = new GPIO();
+        public GPIO Cpu1IRQ { get; } = new GPIO();
+
+        // DBSETn writes that rang at least one doorbell of the given core
+        public ulong Cpu0DoorbellCount => doorbellCount[0];
+        public ulong Cpu1DoorbellCount => doorbellCount[1];
+
+        private void DefineRegisters()
+        {
+            Registers.DoorbellSet.DefineMany(this, NumberOfCores, (register, idx) =>
+                register.WithValueField(0, 32, FieldMode.Write, name: "DBSET",
+                    writeCallback: (_, value) => Ring(idx, (uint)value)), stepInBytes: CoreStride);
+
+            Registers.DoorbellStatus.DefineMany(this, NumberOfCores, (register, idx) =>
+                register.WithValueField(0, 32, name: "DBSTAT",
+                    valueProviderCallback: _ => pending[idx],
+                    writeCallback: (_, value) =>
+                    {
+                        // write 1 to clear
+                        pending[idx] &= ~(uint)value;
+                        UpdateInterrupts();
+                    }), stepInBytes: CoreStride);
+
+            Registers.DoorbellEnable.DefineMany(this, NumberOfCores, (register, idx) =>
+                register.WithValueField(0, 32, out enabled[idx], name: "DBEN",
+                    writeCallback: (_, __) => UpdateInterrupts()), stepInBytes: CoreStride);
+
+            Registers.WindowBase.Define(this)
+                .WithValueField(0, 32, FieldMode.Read, name: "WINBASE", valueProviderCallback: _ => windowAddress);
+
+            Registers.WindowSize.Define(this)
+                .WithValueField(0, 32, FieldMode.Read, name: "WINSIZE", valueProviderCallback: _ => windowSize);
+        }
+
+        private void Ring(int core, uint bits)
+        {
+            if(bits == 0)
+            {
+                return;
+            }
+            this.Log(LogLevel.Noisy, "Doorbell 0x{0:X} rung for cpu{1}", bits, core);
+            doorbellCount[core]++;
+            pending[core] |= bits;
+            UpdateInterrupts();
+        }
+
+        private void UpdateInterrupts()
+        {
+            Cpu0IRQ.Set((pending[0] & enabled[0].Value) != 0);
+            Cpu1IRQ.Set((pending[1] & enabled[1].Value) != 0);
+        }
+
+        private readonly uint windowAddress;
+        private readonly uint windowSize;
+        private readonly uint[] pending;
+        private readonly IValueRegisterField[] enabled;
+        private readonly ulong[] doorbellCount;
+
+        private const int NumberOfCores = 2;
+        private const int CoreStride = 0x10;
+        // top 64 KB of SRAM0, left out of both cores' linker scripts
+        private const uint DefaultWindowAddress = 0x10170000;
+        private const uint DefaultWindowSize = 0x10000;
+
+        private enum Registers
+        {
+            DoorbellSet = 0x00, // DBSETn
+            DoorbellStatus = 0x04, // DBSTATn
+            DoorbellEnable = 0x08, // DBENn
+            WindowBase = 0x40, // WINBASE
+            WindowSize = 0x44, // WINSIZE
+        }
+    }
+}
@@ -4,45 +4,189 @@
 // This file is licensed under the MIT License.
 // Full license text is available in 'licenses/MIT.txt'.
 //
+using System;
 using System.Collections.Generic;
 using Antmicro.Renode.Peripherals.Bus;
 using Antmicro.Renode.Core.Structure.Registers;
 using Antmicro.Renode.Core;
+using Antmicro.Renode.Exceptions;
 using Antmicro.Renode.Utilities;
 using Antmicro.Renode.Logging;
+using Antmicro.Renode.Peripherals.CPU;
+using Antmicro.Renode.Peripherals.IRQControllers;
+using Antmicro.Renode.Peripherals.Timers;
+using Antmicro.Renode.Time;
 
 namespace Antmicro.Renode.Peripherals.UART
 {
     [AllowedTranslations(AllowedTranslation.ByteToDoubleWord)]
     public class Renesas_SCI : UARTBase, IDoubleWordPeripheral, IProvidesRegisterCollection<DoubleWordRegisterCollection>, IKnownSize
     {
-        public Renesas_SCI(IMachine machine) : base(machine)
+        public Renesas_SCI(IMachine machine, bool rxTriggerLevelMode = false, int receiveFifoCapacity = FifoDepth,
+            bool timedMode = false, long frequency = DefaultFrequency) : base(machine)
         {
+            if(receiveFifoCapacity < 1)
+            {
+                throw new ConstructionException($"Invalid receive fifo capacity: {receiveFifoCapacity}");
+            }
+            this.rxTriggerLevelMode = rxTriggerLevelMode;
+            this.timedMode = timedMode;
+            this.frequency = frequency;
+            receiveFifo = new byte[receiveFifoCapacity];
             RegistersCollection = new DoubleWordRegisterCollection(this);
 
             DefineRegisters();
+
+            // both timers count bit periods (etu)
+            receiveTimeoutTimer = new LimitTimer(machine.ClockSource, BaudRate, this, "receiveTimeout", ReceiveTimeoutBitPeriods,
+                direction: Direction.Ascending, workMode: WorkMode.OneShot, eventEnabled: true);
+            receiveTimeoutTimer.LimitReached += ReceiveTimeoutReached;
+
+            transmitTimer = new LimitTimer(machine.ClockSource, BaudRate, this, "transmit", FrameBitPeriods,
+                direction: Direction.Ascending, workMode: WorkMode.Periodic, eventEnabled: true);
+            transmitTimer.LimitReached += TransmitFrameCompleted;
+
+            // bounds the sleep, also for firmware that polls with iteration-counted timeouts
+            idleWakeTimer = new LimitTimer(machine.ClockSource, 1000000, this, "idleWake", DefaultIdleSleepMicroseconds,
+                direction: Direction.Ascending, workMode: WorkMode.OneShot, eventEnabled: true);
+            idleWakeTimer.LimitReached += WakeFromIdle;
         }
 
         public override void WriteChar(byte value)
         {
-            receiveFifo.Enqueue(value);
+            CharArrived?.Invoke(value);
+            WakeFromIdle();
+            TryEnqueueReceived(value);
+            if(RxTriggerLevelMode)
+            {
+                RestartReceiveTimeout();
+            }
+            UpdateInterrupts();
+        }
+
+        public void WriteChars(byte[] data)
+        {
+            WriteChars(data, 0, data.Length);
+        }
+
+        // Block counterpart of WriteChar: interrupts and the receive timeout
+        // are re-evaluated once per block instead of once per character.
+        public void WriteChars(byte[] data, int offset, int count)
+        {
+            if(count <= 0)
+            {
+                return;
+            }
+            WakeFromIdle();
+            var arrived = CharArrived;
+            if(arrived != null)
+            {
+                for(var i = offset; i < offset + count; i++)
+                {
+                    arrived(data[i]);
+                }
+            }
+            for(var i = offset; i < offset + count; i++)
+            {
+                if(!TryEnqueueReceived(data[i]))
+                {
+                    break;
+                }
+            }
+            if(RxTriggerLevelMode)
+            {
+                RestartReceiveTimeout();
+            }
             UpdateInterrupts();
         }
 
+        // DMAC-side counterparts of RDR reads and TDR writes, moving a whole block
+        // with a single interrupt and DMA request re-evaluation.
+        public int ReadReceiveBlock(byte[] destination, int offset, int count)
+        {
+            var read = 0;
+            while(read < count && TryDequeueReceived(out destination[offset + read]))
+            {
+                read++;
+            }
+            if(receiveFifoCount == 0)
+            {
+                receiveDataReady = false;
+            }
+            UpdateInterrupts();
+            return read;
+        }
+
+        public int WriteTransmitBlock(byte[] source, int offset, int count)
+        {
+            var written = 0;
+            if(TimedMode)
+            {
+                // only what fits in the fifo is accepted, the rest waits for the next request
+                while(written < count && transmitFifoCount < FifoDepth)
+                {
+                    EnqueueTransmit(source[offset + written]);
+                    written++;
+                }
+            }
+            else
+            {
+                for(; written < count; written++)
+                {
+                    TransmitCharacter(source[offset + written]);
+                }
+            }
+            UpdateInterrupts();
+            PulseTransmitInterrupts(written > 0, written > 0);
+            return written;
+        }
+
         public uint ReadDoubleWord(long offset)
         {
-            return RegistersCollection.Read(offset);
+            RegisterAccessCount++;
+            if(!FastPathEnabled || !TryReadHotRegister(offset, out var value))
+            {
+                value = RegistersCollection.Read(offset);
+            }
+            if(IdlePollThreshold > 0)
+            {
+                DetectIdlePolling(offset, value);
+            }
+            return value;
         }
 
         public override void Reset()
         {
             base.Reset();
             RegistersCollection.Reset();
-            receiveFifo.Clear();
+            WakeFromIdle();
+            idleWakeTimer.Reset();
+            idlePollCount = 0;
+            IdleEntryCount = 0;
+            RegisterAccessCount = 0;
+            ClearReceiveFifo();
+            receiveOverrun = false;
+            receiveTimeoutTimer.Reset();
+            receiveDataReady = false;
+            receiveInterruptCount = 0;
+            transmitInterruptCount = 0;
+            transmitEndInterruptCount = 0;
+            transmitTimer.Reset();
+            transmitFifoHead = 0;
+            transmitFifoCount = 0;
+            transmitShiftRegisterBusy = false;
+            UpdateBitRate();
         }
 
         public void WriteDoubleWord(long offset, uint value)
         {
+            RegisterAccessCount++;
+            idlePollCount = 0;
+            if(FastPathEnabled && offset == (long)Registers.TransmitData)
+            {
+                WriteTransmitData(value & TransmitDataMask);
+                return;
+            }
             RegistersCollection.Write(offset, value);
         }
 
@@ -54,12 +198,142 @@ namespace Antmicro.Renode.Peripherals.UART
 
         public override Parity ParityBit => Parity.None;
 
-        public override uint BaudRate => 115200;
+        // Instant mode keeps the nominal rate, timed mode follows CCR2.
+        public override uint BaudRate => TimedMode ? CalculateBaudRate() : DefaultBaudRate;
+
+        // When set, TDR writes go through a modelled TX fifo and shift register
+        // drained at the CCR2 bit rate in virtual time; TDRE, TEND and FTSR.T
+        // reflect the fifo state. Otherwise characters are sent immediately and
+        // TXI/TEI are single edges, see PulseTransmitInterrupts.
+        public bool TimedMode
+        {
+            get => timedMode;
+            set
+            {
+                if(timedMode == value)
+                {
+                    return;
+                }
+                timedMode = value;
+                if(!value)
+                {
+                    // flush whatever is still waiting in the modelled fifo
+                    transmitTimer.Enabled = false;
+                    transmitShiftRegisterBusy = false;
+                    while(TryDequeueTransmit(out var pending))
+                    {
+                        TransmitCharacter(pending);
+                    }
+                }
+                UpdateBitRate();
+                UpdateInterrupts();
+                // everything still queued has just been sent
+                PulseTransmitInterrupts(!value, !value);
+            }
+        }
+
+        // When set, RXI follows FCR.RTRG and partial bursts are reported
+        // through the receive timeout (FRSR.DR) instead of per character.
+        public bool RxTriggerLevelMode
+        {
+            get => rxTriggerLevelMode;
+            set
+            {
+                rxTriggerLevelMode = value;
+                if(!value)
+                {
+                    receiveTimeoutTimer.Enabled = false;
+                    receiveDataReady = false;
+                }
+                UpdateInterrupts();
+            }
+        }
+
+        // Dispatches RDR, TDR, CSR and FRSR accesses without the register collection;
+        // can be switched off to compare against the generic path.
+        public bool FastPathEnabled { get; set; } = true;
+
+        public ulong RegisterAccessCount { get; private set; }
+
+        // Route RXI/TXI to the DMAC instead of the CPU, as the ICU DMAC trigger
+        // selection (DMACn_RSSEL) does; the CPU interrupt stays low while selected.
+        public bool ReceiveDmaSelect
+        {
+            get => receiveDmaSelect;
+            set
+            {
+                receiveDmaSelect = value;
+                UpdateInterrupts();
+            }
+        }
+
+        public bool TransmitDmaSelect
+        {
+            get => transmitDmaSelect;
+            set
+            {
+                transmitDmaSelect = value;
+                UpdateInterrupts();
+                PulseTransmitInterrupts(true, false);
+            }
+        }
+
+        // Receive ring size; 16 matches the hardware fifo. Scenarios whose peer delivers
+        // more than that at once (UARTHub passes whole lines) may enlarge it.
+        public int ReceiveFifoCapacity
+        {
+            get => receiveFifo.Length;
+            set
+            {
+                if(value < 1)
+                {
+                    throw new RecoverableException($"Invalid receive fifo capacity: {value}");
+                }
+                var resized = new byte[value];
+                var kept = Math.Min(receiveFifoCount, value);
+                for(var i = 0; i < kept; i++)
+                {
+                    TryDequeueReceived(out resized[i]);
+                }
+                receiveFifo = resized;
+                receiveFifoHead = 0;
+                receiveFifoCount = kept;
+                UpdateInterrupts();
+            }
+        }
+
+        // Busy-poll detection: once CSR or FRSR has been read this many times in a row
+        // with an unchanged value, the polling CPU is halted until the next RX/TX event,
+        // a pending GIC interrupt or for at most IdleSleepMicroseconds of virtual time.
+        // 0 (the default) disables it.
+        public uint IdlePollThreshold { get; set; }
+
+        public ulong IdleSleepMicroseconds
+        {
+            get => idleWakeTimer.Limit;
+            set => idleWakeTimer.Limit = Math.Max(1, value);
+        }
+
+        public ulong IdleEntryCount { get; private set; }
+
+        // Number of RXI/TXI/TEI assertions (low to high transitions) since reset.
+        public ulong ReceiveInterruptCount => receiveInterruptCount;
+        public ulong TransmitInterruptCount => transmitInterruptCount;
+        public ulong TransmitEndInterruptCount => transmitEndInterruptCount;
+
+        // Every character coming in from the link, accepted by the fifo or not;
+        // the receive-side counterpart of CharReceived (which reports transmitted ones).
+        public event Action<byte> CharArrived;
 
         public GPIO RxIRQ { get; } = new GPIO();
         public GPIO TxIRQ { get; } = new GPIO();
         public GPIO TxEndIRQ { get; } = new GPIO();
 
+        // DMAC activation requests, asserted under the same conditions as RXI and TXI
+        // but only when the direction is routed to the DMAC, see ReceiveDmaSelect
+        public GPIO RxDmaRequest { get; } = new GPIO();
+        public GPIO TxDmaRequest { get; } = new GPIO();
+
         protected override void CharWritten()
         {
             // intentionally left blank
@@ -72,37 +346,91 @@ namespace Antmicro.Renode.Peripherals.UART
 
         private void UpdateInterrupts()
         {
-            // On real hardware FCR.RTRG value doesn't affect interrupt requests,
-            // they are triggered for every character in RX fifo.
-            RxIRQ.Set(receiveInterruptEnable.Value && receiveFifo.Count > 0);
+            // By default RXI is requested for every character in RX fifo;
+            // in trigger-level mode only once RTRG is reached or on receive timeout.
+            bool receiveRequest;
+            if(RxTriggerLevelMode)
+            {
+                receiveRequest = receiveFifoCount >= ReceiveTriggerLevel || receiveDataReady;
+            }
+            else
+            {
+                receiveRequest = receiveFifoCount > 0;
+            }
+
+            UpdateInterrupt(RxIRQ, !ReceiveDmaSelect && receiveInterruptEnable.Value && receiveRequest, ref receiveInterruptCount);
+            // TXI while the TX fifo is at or below TTRG, TEI once fifo and shift register are empty;
+            // in instant mode both conditions always hold, so they are pulsed instead
+            UpdateInterrupt(TxIRQ, !TransmitDmaSelect && TimedMode && transmitInterruptEnable.Value && IsTransmitDataEmpty, ref transmitInterruptCount);
+            UpdateInterrupt(TxEndIRQ, TimedMode && transmitEndInterruptEnable.Value && IsTransmitEnd, ref transmitEndInterruptCount);
+
+            // DMA requests go last: the DMAC serves them synchronously and re-enters here
+            UpdateDmaRequest(RxDmaRequest, ReceiveDmaSelect && receiveInterruptEnable.Value && receiveRequest);
+            UpdateDmaRequest(TxDmaRequest, TransmitDmaSelect && TimedMode && transmitInterruptEnable.Value && IsTransmitDataEmpty);
+        }
+
+        private void UpdateDmaRequest(GPIO request, bool state)
+        {
+            if(request.IsSet != state)
+            {
+                request.Set(state);
+            }
+        }
 
-            TxEndIRQ.Set(transmitEndInterruptEnable.Value);
-            TxIRQ.Set(transmitInterruptEnable.Value);
+        // Instant mode: every accepted write, and setting TIE/TEIE, raises a single TXI/TEI edge
+        // (the TX DMA request instead of TXI if selected). The interrupt controller has to
+        // latch them, i.e. the lines must be edge-triggered.
+        private void PulseTransmitInterrupts(bool transmit, bool transmitEnd)
+        {
+            if(TimedMode)
+            {
+                return;
+            }
+            if(transmit && transmitInterruptEnable.Value)
+            {
+                if(TransmitDmaSelect)
+                {
+                    TxDmaRequest.Blink();
+                }
+                else
+                {
+                    transmitInterruptCount++;
+                    TxIRQ.Blink();
+                }
+            }
+            if(transmitEnd && transmitEndInterruptEnable.Value)
+            {
+                transmitEndInterruptCount++;
+                TxEndIRQ.Blink();
+            }
+        }
+
+        private void UpdateInterrupt(GPIO irq, bool state, ref ulong assertionCount)
+        {
+            // only real level changes are propagated to the interrupt controller
+            if(irq.IsSet == state)
+            {
+                return;
+            }
+            if(state)
+            {
+                assertionCount++;
+            }
+            irq.Set(state);
         }
 
         private void DefineRegisters()
         {
             Registers.ReceiveData.Define(this, resetValue: 0x0)
                 .WithValueField(0, 9, FieldMode.Read, name: "RDAT",
-                    valueProviderCallback: _ =>
-                    {
-                        if(!receiveFifo.TryDequeue(out byte value))
-                        {
-                            this.Log(LogLevel.Warning, "Trying to read data from empty receive fifo");
-                        }
-                        UpdateInterrupts();
-                        return value;
-                    })
+                    valueProviderCallback: _ => ReadReceiveData())
                 .WithTaggedFlag("MPB", 9)
                 .WithFlag(10, mode: FieldMode.Read, name: "DR",
-                    valueProviderCallback: _ =>
-                    {
-                        return receiveFifo.Count > 0;
-                    })
+                    valueProviderCallback: _ => IsReceiveDataReady)
                 .WithTaggedFlag("FPER", 11)
                 .WithTaggedFlag("FFER", 12)
                 .WithReservedBits(13, 11)
-                .WithTaggedFlag("ORER", 24)
+                .WithFlag(24, FieldMode.Read, name: "ORER", valueProviderCallback: _ => receiveOverrun)
                 .WithReservedBits(25, 2)
                 .WithTaggedFlag("PER", 27)
                 .WithTaggedFlag("FER", 28)
@@ -110,14 +438,7 @@ namespace Antmicro.Renode.Peripherals.UART
 
             Registers.TransmitData.Define(this, resetValue: 0xffffffff)
                 .WithValueField(0, 9, FieldMode.Write, name: "TDAT",
-                    writeCallback: (_, value) =>
-                    {
-                        if(BitHelper.IsBitSet(value, 8))
-                        {
-                            this.Log(LogLevel.Warning, "Trying to transmit data with 9-th bit set: {0:X}, sending: {1:X}", value, (byte)value);
-                        }
-                        this.TransmitCharacter((byte)value);
-                    })
+                    writeCallback: (_, value) => WriteTransmitData((uint)value))
                 .WithTaggedFlag("MPBT", 9)
                 .WithReservedBits(10, 22);
 
@@ -133,8 +454,10 @@ namespace Antmicro.Renode.Peripherals.UART
                 .WithReservedBits(11, 5)
                 .WithFlag(16, out receiveInterruptEnable, name: "RIE")
                 .WithReservedBits(17, 3)
-                .WithFlag(20, out transmitInterruptEnable, name: "TIE")
-                .WithFlag(21, out transmitEndInterruptEnable, name: "TEIE")
+                .WithFlag(20, out transmitInterruptEnable, name: "TIE",
+                    changeCallback: (_, value) => PulseTransmitInterrupts(value, false))
+                .WithFlag(21, out transmitEndInterruptEnable, name: "TEIE",
+                    changeCallback: (_, value) => PulseTransmitInterrupts(false, value))
                 .WithReservedBits(22, 2)
                 .WithTaggedFlag("SSE", 24)
                 .WithReservedBits(25, 7)
@@ -165,16 +488,17 @@ namespace Antmicro.Renode.Peripherals.UART
             Registers.CommonControl2.Define(this, 0xff00ff04)
                 .WithTag("BCP", 0, 3)
                 .WithReservedBits(3, 1)
-                .WithTaggedFlag("BGDM", 4)
-                .WithTaggedFlag("ABCS", 5)
+                .WithFlag(4, out baudRateGeneratorDoubleSpeed, name: "BGDM")
+                .WithFlag(5, out asynchronousBaseClockSelect, name: "ABCS")
                 .WithTaggedFlag("ABCSE", 6)
                 .WithReservedBits(7, 1)
-                .WithTag("BRR", 8, 8)
-                .WithTaggedFlag("BRME", 16)
+                .WithValueField(8, 8, out bitRate, name: "BRR")
+                .WithFlag(16, out bitRateModulationEnable, name: "BRME")
                 .WithReservedBits(17, 3)
-                .WithTag("CKS", 20, 2)
+                .WithValueField(20, 2, out clockSelect, name: "CKS")
                 .WithReservedBits(22, 2)
-                .WithTag("MDDR", 24, 8);
+                .WithValueField(24, 8, out modulationDuty, name: "MDDR")
+                .WithWriteCallback((_, __) => UpdateBitRate());
 
             Registers.CommonControl3.Define(this, 0x00001203)
                 .WithTaggedFlag("CPHA", 0)
@@ -228,11 +552,12 @@ namespace Antmicro.Renode.Peripherals.UART
             Registers.FIFOControlRegister.Define(this, resetValue: 0x1f1f0000)
                 .WithTaggedFlag("DRES", 0)
                 .WithReservedBits(1, 7)
-                .WithTag("TTRG", 8, 5)
+                .WithValueField(8, 5, out transmitFifoDataTriggerNumber, name: "TTRG",
+                    writeCallback: (_, __) => UpdateInterrupts())
                 .WithReservedBits(13, 2)
                 .WithTaggedFlag("TFRST", 15)
-                // On real hardware FCR.RTRG value doesn't affect interrupt requests
-                // they are triggered for every character in RX fifo.
+                // RTRG is only taken into account in trigger-level mode,
+                // see UpdateInterrupts
                 .WithValueField(16, 5, out receiveFifoDataTriggerNumber, name: "RTRG",
                     writeCallback: (oldValue, newValue) =>
                     {
@@ -263,17 +588,14 @@ namespace Antmicro.Renode.Peripherals.UART
                 .WithTaggedFlag("DPER", 17)
                 .WithTaggedFlag("DFER", 18)
                 .WithReservedBits(19, 5)
-                .WithTaggedFlag("ORER", 24)
+                .WithFlag(24, FieldMode.Read, name: "ORER", valueProviderCallback: _ => receiveOverrun)
                 .WithReservedBits(25, 1)
                 .WithTaggedFlag("MFF", 26)
                 .WithTaggedFlag("PER", 27)
                 .WithTaggedFlag("FER", 28)
-                .WithFlag(29, FieldMode.Read, name: "TDRE", valueProviderCallback: _ => true)
-                .WithFlag(30, FieldMode.Read, name: "TEND", valueProviderCallback: _ => true)
-                .WithFlag(31, FieldMode.Read, name: "RDRF", valueProviderCallback: _ =>
-                {
-                    return true;
-                });
+                .WithFlag(29, FieldMode.Read, name: "TDRE", valueProviderCallback: _ => IsTransmitDataEmpty)
+                .WithFlag(30, FieldMode.Read, name: "TEND", valueProviderCallback: _ => IsTransmitEnd)
+                .WithFlag(31, FieldMode.Read, name: "RDRF", valueProviderCallback: _ => true);
 
             Registers.SimpleI2CStatus.Define(this)
                 .WithTaggedFlag("IICACKR", 0)
@@ -283,13 +605,10 @@ namespace Antmicro.Renode.Peripherals.UART
 
             Registers.FIFOReceiveStatus.Define(this, resetValue: 0x0)
                 .WithFlag(0, mode: FieldMode.Read, name: "DR",
-                    valueProviderCallback: _ =>
-                    {
-                        return receiveFifo.Count > 0;
-                    })
+                    valueProviderCallback: _ => IsReceiveDataReady)
                 .WithReservedBits(1, 7)
                 .WithValueField(8, 6, FieldMode.Read, name: "R",
-                    valueProviderCallback: _ => (ulong)receiveFifo.Count)
+                    valueProviderCallback: _ => (ulong)ReceiveFifoLevel)
                 .WithReservedBits(14, 2)
                 .WithTag("PNUM", 16, 6)
                 .WithReservedBits(22, 2)
@@ -297,10 +616,7 @@ namespace Antmicro.Renode.Peripherals.UART
                 .WithReservedBits(30, 2);
 
             Registers.FIFOTransmitStatus.Define(this)
-                .WithValueField(0, 6, FieldMode.Read, name: "T", valueProviderCallback: _ =>
-                {
-                    return 0;
-                })
+                .WithValueField(0, 6, FieldMode.Read, name: "T", valueProviderCallback: _ => (ulong)transmitFifoCount)
                 .WithReservedBits(6, 26);
 
             Registers.CommonFlagClear.Define(this)
@@ -311,7 +627,14 @@ namespace Antmicro.Renode.Peripherals.UART
                 .WithTaggedFlag("DPERC", 17)
                 .WithTaggedFlag("DFERC", 18)
                 .WithReservedBits(19, 5)
-                .WithTaggedFlag("ORERC", 24)
+                .WithFlag(24, FieldMode.Write, name: "ORERC",
+                    writeCallback: (_, value) =>
+                    {
+                        if(value)
+                        {
+                            receiveOverrun = false;
+                        }
+                    })
                 .WithReservedBits(25, 1)
                 .WithTaggedFlag("MFFS", 26)
                 .WithTaggedFlag("PERC", 27)
@@ -326,16 +649,414 @@ namespace Antmicro.Renode.Peripherals.UART
                 .WithReservedBits(4, 27);
 
             Registers.FIFOFlagClear.Define(this)
-                .WithTaggedFlag("DRC", 0)
+                .WithFlag(0, FieldMode.Write, name: "DRC",
+                    writeCallback: (_, value) =>
+                    {
+                        if(value)
+                        {
+                            receiveDataReady = false;
+                            UpdateInterrupts();
+                        }
+                    })
                 .WithReservedBits(1, 31);
         }
 
+        private bool TryReadHotRegister(long offset, out uint value)
+        {
+            // registers polled in tight loops by firmware skip the generic field walk,
+            // the values are composed exactly as the register definitions do
+            switch((Registers)offset)
+            {
+            case Registers.ReceiveData:
+                value = ReadReceiveData();
+                value |= (IsReceiveDataReady ? ReceiveDataReadyBit : 0u) | (receiveOverrun ? ReceiveOverrunBit : 0u);
+                return true;
+            case Registers.CommonStatus:
+                value = CommonStatusValue;
+                return true;
+            case Registers.FIFOReceiveStatus:
+                value = FIFOReceiveStatusValue;
+                return true;
+            default:
+                value = 0;
+                return false;
+            }
+        }
+
+        private void DetectIdlePolling(long offset, uint value)
+        {
+            var isStatus = offset == (long)Registers.FIFOReceiveStatus || offset == (long)Registers.CommonStatus;
+            if(!isStatus || offset != lastPolledOffset || value != lastPolledValue)
+            {
+                lastPolledOffset = offset;
+                lastPolledValue = value;
+                idlePollCount = 0;
+                return;
+            }
+            if(++idlePollCount < IdlePollThreshold)
+            {
+                return;
+            }
+            idlePollCount = 0;
+            EnterIdle();
+        }
+
+        private void EnterIdle()
+        {
+            if(idleCpu != null || !machine.SystemBus.TryGetCurrentCPU(out var cpu))
+            {
+                return;
+            }
+            WatchInterruptControllers();
+            if(IsInterruptPending())
+            {
+                return;
+            }
+            idleCpu = cpu;
+            IdleEntryCount++;
+            this.Log(LogLevel.Noisy, "Busy polling detected, halting {0} until the next SCI event or interrupt", cpu);
+            cpu.IsHalted = true;
+            idleWakeTimer.Value = 0;
+            idleWakeTimer.Enabled = true;
+        }
+
+        // Any interrupt the GICs signal to a core (timer, GPIO, IPC...) ends the sleep as well,
+        // the hooks are attached on the first idle entry and stay for the machine's lifetime
+        private void WatchInterruptControllers()
+        {
+            if(interruptControllerOutputs != null)
+            {
+                return;
+            }
+            interruptControllerOutputs = new List<IGPIO>();
+            foreach(var gic in machine.GetPeripheralsOfType<ARM_GenericInterruptController>())
+            {
+                foreach(var output in gic.Connections.Values)
+                {
+                    interruptControllerOutputs.Add(output);
+                    output.AddStateChangedHook(state =>
+                    {
+                        if(state)
+                        {
+                            WakeFromIdle();
+                        }
+                    });
+                }
+            }
+        }
+
+        private bool IsInterruptPending()
+        {
+            foreach(var output in interruptControllerOutputs)
+            {
+                if(output.IsSet)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        private void WakeFromIdle()
+        {
+            if(idleCpu == null)
+            {
+                return;
+            }
+            idleWakeTimer.Enabled = false;
+            idleCpu.IsHalted = false;
+            idleCpu = null;
+            idlePollCount = 0;
+        }
+
+        private uint ReadReceiveData()
+        {
+            if(!TryDequeueReceived(out byte value))
+            {
+                this.Log(LogLevel.Warning, "Trying to read data from empty receive fifo");
+            }
+            if(receiveFifoCount == 0)
+            {
+                // the model drops DR once the fifo is drained, so polling
+                // software that never writes FFCLR.DRC keeps working
+                receiveDataReady = false;
+            }
+            UpdateInterrupts();
+            return value;
+        }
+
+        private void WriteTransmitData(uint value)
+        {
+            if(BitHelper.IsBitSet(value, 8))
+            {
+                this.Log(LogLevel.Warning, "Trying to transmit data with 9-th bit set: {0:X}, sending: {1:X}", value, (byte)value);
+            }
+            if(TimedMode)
+            {
+                QueueTransmit((byte)value);
+            }
+            else
+            {
+                this.TransmitCharacter((byte)value);
+                PulseTransmitInterrupts(true, true);
+            }
+        }
+
+        // CSR and FRSR are read-only, so their value is fully determined by the model state;
+        // RXDM ON keeps its reset value and RDRF always reads as set
+        private uint CommonStatusValue => CommonStatusReceiveDataMonitorBit
+            | (receiveOverrun ? ReceiveOverrunBit : 0u)
+            | (IsTransmitDataEmpty ? TransmitDataEmptyBit : 0u)
+            | (IsTransmitEnd ? TransmitEndBit : 0u)
+            | ReceiveDataFullBit;
+
+        private uint FIFOReceiveStatusValue => (IsReceiveDataReady ? 1u : 0u) | ((uint)ReceiveFifoLevel << 8);
+
+        private void RestartReceiveTimeout()
+        {
+            receiveTimeoutTimer.Enabled = false;
+            receiveTimeoutTimer.Value = 0;
+            receiveTimeoutTimer.Enabled = true;
+        }
+
+        private void ReceiveTimeoutReached()
+        {
+            WakeFromIdle();
+            if(receiveFifoCount == 0)
+            {
+                return;
+            }
+            receiveDataReady = true;
+            UpdateInterrupts();
+        }
+
+        private bool IsReceiveDataReady => RxTriggerLevelMode ? receiveDataReady : receiveFifoCount > 0;
+
+        // RTRG of 0 would never deassert the request, values above the fifo depth are unreachable
+        private int ReceiveTriggerLevel => (int)Math.Max(1, Math.Min(receiveFifoDataTriggerNumber.Value, (ulong)Math.Min(FifoDepth, receiveFifo.Length)));
+
+        // FRSR.R is 6 bits wide, an enlarged receive ring saturates it
+        private int ReceiveFifoLevel => Math.Min(receiveFifoCount, 0x3F);
+
+        private bool TryEnqueueReceived(byte value)
+        {
+            // as on hardware, reception is stopped until ORER is cleared
+            if(receiveOverrun || receiveFifoCount == receiveFifo.Length)
+            {
+                if(!receiveOverrun)
+                {
+                    this.Log(LogLevel.Warning, "Receive fifo overrun, dropping 0x{0:X} and further data until CFCLR.ORERC is written", value);
+                    receiveOverrun = true;
+                }
+                return false;
+            }
+
+            var tail = receiveFifoHead + receiveFifoCount;
+            if(tail >= receiveFifo.Length)
+            {
+                tail -= receiveFifo.Length;
+            }
+            receiveFifo[tail] = value;
+            receiveFifoCount++;
+            return true;
+        }
+
+        private bool TryDequeueReceived(out byte value)
+        {
+            if(receiveFifoCount == 0)
+            {
+                value = 0;
+                return false;
+            }
+
+            value = receiveFifo[receiveFifoHead];
+            if(++receiveFifoHead == receiveFifo.Length)
+            {
+                receiveFifoHead = 0;
+            }
+            receiveFifoCount--;
+            return true;
+        }
+
+        private void QueueTransmit(byte value)
+        {
+            if(transmitFifoCount == FifoDepth)
+            {
+                this.Log(LogLevel.Warning, "Transmit fifo full, dropping 0x{0:X}", value);
+                return;
+            }
+            EnqueueTransmit(value);
+            UpdateInterrupts();
+        }
+
+        private void EnqueueTransmit(byte value)
+        {
+            var tail = transmitFifoHead + transmitFifoCount;
+            if(tail >= FifoDepth)
+            {
+                tail -= FifoDepth;
+            }
+            transmitFifo[tail] = value;
+            transmitFifoCount++;
+
+            if(!transmitShiftRegisterBusy)
+            {
+                LoadTransmitShiftRegister();
+            }
+        }
+
+        private bool TryDequeueTransmit(out byte value)
+        {
+            if(transmitFifoCount == 0)
+            {
+                value = 0;
+                return false;
+            }
+
+            value = transmitFifo[transmitFifoHead];
+            if(++transmitFifoHead == FifoDepth)
+            {
+                transmitFifoHead = 0;
+            }
+            transmitFifoCount--;
+            return true;
+        }
+
+        private void LoadTransmitShiftRegister()
+        {
+            if(!TryDequeueTransmit(out transmitShiftRegister))
+            {
+                transmitShiftRegisterBusy = false;
+                transmitTimer.Enabled = false;
+                return;
+            }
+            transmitShiftRegisterBusy = true;
+            if(!transmitTimer.Enabled)
+            {
+                transmitTimer.Value = 0;
+                transmitTimer.Enabled = true;
+            }
+        }
+
+        private void TransmitFrameCompleted()
+        {
+            WakeFromIdle();
+            // the character leaves the line once its whole frame has been shifted out
+            TransmitCharacter(transmitShiftRegister);
+            LoadTransmitShiftRegister();
+            UpdateInterrupts();
+        }
+
+        private void UpdateBitRate()
+        {
+            var baudRate = BaudRate;
+            if(baudRate == 0)
+            {
+                this.Log(LogLevel.Warning, "CCR2 configuration results in a zero bit rate, keeping the previous timing");
+                return;
+            }
+            // the constructor defines (and so initialises) the registers before the timers
+            // exist; they pick up the reset bit rate when they are created
+            if(transmitTimer == null)
+            {
+                return;
+            }
+            transmitTimer.Frequency = baudRate;
+            receiveTimeoutTimer.Frequency = baudRate;
+        }
+
+        private uint CalculateBaudRate()
+        {
+            // B = PCLKSCI / (64 * 2^(2n - 1) * (N + 1)), where n = CKS and N = BRR;
+            // BGDM and ABCS each double the rate, BRME scales it by MDDR / 256
+            var divisor = 32.0 * (1 << (2 * (int)clockSelect.Value)) * (bitRate.Value + 1);
+            if(baudRateGeneratorDoubleSpeed.Value)
+            {
+                divisor /= 2;
+            }
+            if(asynchronousBaseClockSelect.Value)
+            {
+                divisor /= 2;
+            }
+            var rate = frequency / divisor;
+            if(bitRateModulationEnable.Value)
+            {
+                rate = rate * modulationDuty.Value / 256;
+            }
+            return (uint)Math.Round(rate);
+        }
+
+        // in fifo mode TDRE means the fifo has dropped to the TTRG level
+        private bool IsTransmitDataEmpty => !TimedMode || transmitFifoCount <= TransmitTriggerLevel;
+
+        private bool IsTransmitEnd => !TimedMode || (transmitFifoCount == 0 && !transmitShiftRegisterBusy);
+
+        // TTRG above the fifo depth would mean "never empty"
+        private int TransmitTriggerLevel => (int)Math.Min(transmitFifoDataTriggerNumber.Value, (ulong)FifoDepth - 1);
+
+        private void ClearReceiveFifo()
+        {
+            receiveFifoHead = 0;
+            receiveFifoCount = 0;
+        }
+
         private IValueRegisterField receiveFifoDataTriggerNumber;
+        private IValueRegisterField transmitFifoDataTriggerNumber;
+        private IValueRegisterField bitRate;
+        private IValueRegisterField clockSelect;
+        private IValueRegisterField modulationDuty;
+        private IFlagRegisterField baudRateGeneratorDoubleSpeed;
+        private IFlagRegisterField asynchronousBaseClockSelect;
+        private IFlagRegisterField bitRateModulationEnable;
         private IFlagRegisterField receiveInterruptEnable;
         private IFlagRegisterField transmitInterruptEnable;
         private IFlagRegisterField transmitEndInterruptEnable;
 
-        private readonly Queue<byte> receiveFifo = new Queue<byte>();
+        private bool rxTriggerLevelMode;
+        private bool receiveDmaSelect;
+        private bool transmitDmaSelect;
+        private ICPU idleCpu;
+        private List<IGPIO> interruptControllerOutputs;
+        private uint idlePollCount;
+        private long lastPolledOffset = -1;
+        private uint lastPolledValue;
+        private bool timedMode;
+        private bool transmitShiftRegisterBusy;
+        private byte transmitShiftRegister;
+        private int transmitFifoHead;
+        private int transmitFifoCount;
+        private bool receiveDataReady;
+        private bool receiveOverrun;
+        private ulong receiveInterruptCount;
+        private ulong transmitInterruptCount;
+        private ulong transmitEndInterruptCount;
+        private int receiveFifoHead;
+        private int receiveFifoCount;
+
+        private readonly long frequency;
+        private readonly LimitTimer receiveTimeoutTimer;
+        private readonly LimitTimer transmitTimer;
+        private readonly LimitTimer idleWakeTimer;
+        private readonly byte[] transmitFifo = new byte[FifoDepth];
+        // fixed-size ring, only reallocated when ReceiveFifoCapacity is changed
+        private byte[] receiveFifo;
+
+        private const int FifoDepth = 16;
+        private const ulong DefaultIdleSleepMicroseconds = 1000;
+        private const uint TransmitDataMask = 0x1FF;
+        private const uint ReceiveDataReadyBit = 1u << 10;
+        private const uint ReceiveOverrunBit = 1u << 24;
+        private const uint CommonStatusReceiveDataMonitorBit = 1u << 15;
+        private const uint TransmitDataEmptyBit = 1u << 29;
+        private const uint TransmitEndBit = 1u << 30;
+        private const uint ReceiveDataFullBit = 1u << 31;
+        private const uint DefaultBaudRate = 115200;
+        // PCLKSCI
+        private const long DefaultFrequency = 96000000;
+        // start bit, 8 data bits and a stop bit, matching StopBits and ParityBit
+        private const ulong FrameBitPeriods = 10;
+        // 15 etu of line inactivity, as specified for FRSR.DR
+        private const ulong ReceiveTimeoutBitPeriods = 15;
 
         private enum Registers : long
         {
@@ -0,0 +1,297 @@
+using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Text;
+using Antmicro.Renode.Core;
+using Antmicro.Renode.Exceptions;
+using Antmicro.Renode.Logging;
+
+namespace Antmicro.Renode.Peripherals.UART
+{
+    // Binary capture of UART traffic, from the monitor:
+    //   sysbus.sci0 StartCapture @link.rzcap
+    //   sysbus.sci0 StopCapture
+    // Capturing every UART connected to a UARTHub into the same file records the whole
+    // hub, each byte tagged with the UART (and machine) that sent or received it.
+    // Transmitted bytes are recorded for any IUART, received ones for Renesas_SCI.
+    // A file is truncated when its first UART is attached, so every run starts a new
+    // capture; removing the machine or clearing the emulation stops its captures.
+    // Decode with tools/rzcap_decode.py.
+    public static class UARTCaptureExtensions
+    {
+        public static void StartCapture(this IUART uart, string path)
+        {
+            lock(captures)
+            {
+                if(attached.ContainsKey(uart))
+                {
+                    throw new RecoverableException("This UART is already being captured, call StopCapture first");
+                }
+                if(!EmulationManager.Instance.CurrentEmulation.TryGetMachineForPeripheral(uart, out var machine))
+                {
+                    throw new RecoverableException("The UART is not attached to any machine");
+                }
+                EmulationManager.Instance.CurrentEmulation.TryGetMachineName(machine, out var machineName);
+                WatchEmulation();
+
+                var fullPath = Path.GetFullPath(path);
+                if(!captures.TryGetValue(fullPath, out var writer))
+                {
+                    writer = new CaptureWriter(fullPath);
+                    captures[fullPath] = writer;
+                }
+                var source = writer.AddSource($"{machineName}:{machine.GetLocalName(uart)}");
+                var tap = new Tap(writer, machine, source);
+                attached[uart] = tap;
+
+                uart.CharReceived += tap.OnTransmit;
+                if(uart is Renesas_SCI sci)
+                {
+                    sci.CharArrived += tap.OnReceive;
+                }
+            }
+        }
+
+        public static void StopCapture(this IUART uart)
+        {
+            lock(captures)
+            {
+                if(!attached.TryGetValue(uart, out var tap))
+                {
+                    return;
+                }
+                attached.Remove(uart);
+                uart.CharReceived -= tap.OnTransmit;
+                if(uart is Renesas_SCI sci)
+                {
+                    sci.CharArrived -= tap.OnReceive;
+                }
+
+                if(tap.Writer.Release())
+                {
+                    captures.Remove(tap.Writer.Path);
+                }
+            }
+        }
+
+        public static void FlushCapture(this IUART uart)
+        {
+            lock(captures)
+            {
+                if(attached.TryGetValue(uart, out var tap))
+                {
+                    tap.Writer.Flush();
+                }
+            }
+        }
+
+        private static void WatchEmulation()
+        {
+            var emulation = EmulationManager.Instance.CurrentEmulation;
+            if(watchedEmulation == emulation)
+            {
+                return;
+            }
+            if(watchedEmulation == null)
+            {
+                EmulationManager.Instance.EmulationChanged += StopAllCaptures;
+            }
+            watchedEmulation = emulation;
+            emulation.MachineRemoved += StopCaptures;
+        }
+
+        // the registry must not keep UARTs (and their machines) alive once they are gone
+        private static void StopCaptures(IMachine machine)
+        {
+            lock(captures)
+            {
+                foreach(var uart in new List<IUART>(attached.Keys))
+                {
+                    if(attached[uart].Machine == machine)
+                    {
+                        uart.StopCapture();
+                    }
+                }
+            }
+        }
+
+        private static void StopAllCaptures()
+        {
+            lock(captures)
+            {
+                foreach(var uart in new List<IUART>(attached.Keys))
+                {
+                    uart.StopCapture();
+                }
+            }
+        }
+
+        private static Emulation watchedEmulation;
+        private static readonly Dictionary<string, CaptureWriter> captures = new Dictionary<string, CaptureWriter>();
+        private static readonly Dictionary<IUART, Tap> attached = new Dictionary<IUART, Tap>();
+
+        private class Tap
+        {
+            public Tap(CaptureWriter writer, IMachine machine, byte source)
+            {
+                Writer = writer;
+                this.machine = machine;
+                this.source = source;
+            }
+
+            public void OnTransmit(byte value)
+            {
+                Writer.Append(machine.ElapsedVirtualTime.TimeElapsed.TotalMicroseconds, source, RecordKind.Transmit, value);
+            }
+
+            public void OnReceive(byte value)
+            {
+                Writer.Append(machine.ElapsedVirtualTime.TimeElapsed.TotalMicroseconds, source, RecordKind.Receive, value);
+            }
+
+            public CaptureWriter Writer { get; }
+            public IMachine Machine => machine;
+
+            private readonly IMachine machine;
+            private readonly byte source;
+        }
+
+        // An 8-byte header ("RZTCAP", version, 0) followed by records.
+        //   source:  kind 0, u8 id, u8 name length, UTF-8 name
+        //   byte:    kind 1 (RX) / 2 (TX), u64 virtual time in us, u8 source id, u8 value
+        // Records are encoded straight into one reusable buffer, written out when it fills up.
+        private class CaptureWriter
+        {
+            public CaptureWriter(string path)
+            {
+                Path = path;
+                try
+                {
+                    // a leftover from an earlier run is replaced, not appended to
+                    stream = new FileStream(path, FileMode.Create, FileAccess.Write, FileShare.Read);
+                }
+                catch(Exception e) when(e is IOException || e is UnauthorizedAccessException)
+                {
+                    throw new RecoverableException($"Could not open capture file {path}: {e.Message}");
+                }
+                Put(Encoding.ASCII.GetBytes(Magic));
+                Put(FormatVersion);
+                Put(0);
+                AppDomain.CurrentDomain.ProcessExit += OnProcessExit;
+            }
+
+            public byte AddSource(string name)
+            {
+                var encoded = Encoding.UTF8.GetBytes(name);
+                lock(buffer)
+                {
+                    if(sources == byte.MaxValue)
+                    {
+                        throw new RecoverableException($"Too many UARTs captured into {Path}");
+                    }
+                    var id = sources++;
+                    users++;
+                    Reserve(3 + encoded.Length);
+                    Put((byte)RecordKind.Source);
+                    Put(id);
+                    Put((byte)Math.Min(encoded.Length, byte.MaxValue));
+                    Put(encoded, Math.Min(encoded.Length, byte.MaxValue));
+                    return id;
+                }
+            }
+
+            // machines running on different host threads may share one file
+            public void Append(ulong timestamp, byte source, RecordKind kind, byte value)
+            {
+                lock(buffer)
+                {
+                    Reserve(ByteRecordSize);
+                    buffer[used++] = (byte)kind;
+                    for(var i = 0; i < 8; i++)
+                    {
+                        buffer[used++] = (byte)(timestamp >> (8 * i));
+                    }
+                    buffer[used++] = source;
+                    buffer[used++] = value;
+                }
+            }
+
+            public void Flush()
+            {
+                lock(buffer)
+                {
+                    if(used > 0 && stream != null)
+                    {
+                        stream.Write(buffer, 0, used);
+                        stream.Flush();
+                    }
+                    used = 0;
+                }
+            }
+
+            // returns true once the last UART using the file is gone and the file is closed
+            public bool Release()
+            {
+                lock(buffer)
+                {
+                    if(--users > 0)
+                    {
+                        return false;
+                    }
+                    Flush();
+                    stream.Dispose();
+                    stream = null;
+                    AppDomain.CurrentDomain.ProcessExit -= OnProcessExit;
+                    Logger.Log(LogLevel.Info, "UART capture {0} closed", Path);
+                    return true;
+                }
+            }
+
+            public string Path { get; }
+
+            private void OnProcessExit(object sender, EventArgs e)
+            {
+                Flush();
+            }
+
+            private void Reserve(int count)
+            {
+                if(used + count > buffer.Length)
+                {
+                    stream.Write(buffer, 0, used);
+                    used = 0;
+                }
+            }
+
+            private void Put(byte value)
+            {
+                buffer[used++] = value;
+            }
+
+            private void Put(byte[] data, int count = -1)
+            {
+                count = count < 0 ? data.Length : count;
+                Array.Copy(data, 0, buffer, used, count);
+                used += count;
+            }
+
+            private FileStream stream;
+            private int used;
+            private int users;
+            private byte sources;
+            private readonly byte[] buffer = new byte[BufferSize];
+
+            private const string Magic = "RZTCAP";
+            private const byte FormatVersion = 1;
+            private const int ByteRecordSize = 11;
+            private const int BufferSize = 64 * 1024;
+        }
+
+        private enum RecordKind : byte
+        {
+            Source = 0,
+            Receive = 1,
+            Transmit = 2,
+        }
+    }
+}
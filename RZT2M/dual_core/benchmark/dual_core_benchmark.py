@@ -0,0 +1,109 @@
+# Helpers for comparing the two-machine and the dual-core RZ/T2M setups.
+# Load with `include @.../dual_core_benchmark.py`, every `mc_*` function becomes a monitor command.
+
+from System.Diagnostics import Stopwatch
+
+def mapped_memory_bytes(machine):
+    from Antmicro.Renode.Peripherals.Memory import MappedMemory
+    return sum(m.Size for m in machine.GetPeripheralsOfType[MappedMemory]())
+
+def mc_pingpong_benchmark(label, machines, uart, seconds=1):
+    """pingpong_benchmark label "mach0[,mach1]" uart [virtual seconds]"""
+    names = str(machines).split(",")
+    sent = [0]
+    def on_char(_):
+        sent[0] += 1
+
+    # CharReceived fires for every character the ping side (first machine) transmits;
+    # it only sends the next "ping" after the "pong" came back
+    monitor.Parse('mach set "%s"' % names[0])
+    sci = monitor.Machine["sysbus." + str(uart)]
+    sci.CharReceived += on_char
+
+    memory = 0
+    for name in names:
+        monitor.Parse('mach set "%s"' % name)
+        memory += mapped_memory_bytes(monitor.Machine)
+
+    watch = Stopwatch.StartNew()
+    monitor.Parse('emulation RunFor "%s"' % str(seconds))
+    watch.Stop()
+    sci.CharReceived -= on_char
+
+    print("%s: %d machine(s), %.1f MB mapped memory, %d chars sent by the ping side in %s virtual s, %.3f host s" %
+          (label, len(names), memory / (1024.0 * 1024.0), sent[0], seconds, watch.Elapsed.TotalSeconds))
+
+def virtual_us(machine):
+    return machine.ElapsedVirtualTime.TimeElapsed.TotalMicroseconds
+
+class RoundTrips(object):
+    # request/reply timestamps in virtual microseconds of the machine that saw them
+    def __init__(self):
+        self.started = None
+        self.samples = []
+
+    def request(self, machine):
+        if self.started is None:
+            self.started = virtual_us(machine)
+
+    def reply(self, machine):
+        if self.started is not None:
+            self.samples.append(virtual_us(machine) - self.started)
+            self.started = None
+
+    def report(self, label, seconds, watch):
+        count = len(self.samples)
+        mean = float(sum(self.samples)) / count if count else 0.0
+        # host time covers the whole run, pacing delays included, on both transports alike
+        print("%s: %d round trips in %s virtual s, %.1f virtual us per round trip, %.3f host ms per round trip" %
+              (label, count, seconds, mean, watch.Elapsed.TotalMilliseconds / max(count, 1)))
+
+def run_for(seconds):
+    watch = Stopwatch.StartNew()
+    monitor.Parse('emulation RunFor "%s"' % str(seconds))
+    watch.Stop()
+    return watch
+
+def mc_uart_roundtrip_benchmark(ping_machine, ping_uart, pong_machine, pong_uart, seconds=5):
+    """uart_roundtrip_benchmark ping_mach ping_uart pong_mach pong_uart [virtual seconds]"""
+    trips = RoundTrips()
+    monitor.Parse('mach set "%s"' % str(ping_machine))
+    ping = monitor.Machine
+    monitor.Parse('mach set "%s"' % str(pong_machine))
+    pong = monitor.Machine
+
+    # "ping\r\n" starts with its first character, "pong\r\n" is complete with its last
+    def on_ping(c):
+        if c == ord('p'):
+            trips.request(ping)
+    def on_pong(c):
+        if c == ord('\n'):
+            trips.reply(pong)
+
+    ping_sci = ping["sysbus." + str(ping_uart)]
+    pong_sci = pong["sysbus." + str(pong_uart)]
+    ping_sci.CharReceived += on_ping
+    pong_sci.CharReceived += on_pong
+    watch = run_for(seconds)
+    ping_sci.CharReceived -= on_ping
+    pong_sci.CharReceived -= on_pong
+    trips.report("UART (%s.%s <-> %s.%s)" % (ping_machine, ping_uart, pong_machine, pong_uart), seconds, watch)
+
+def mc_ipc_roundtrip_benchmark(seconds=5):
+    """ipc_roundtrip_benchmark [virtual seconds] - on the current dual-core machine"""
+    trips = RoundTrips()
+    machine = monitor.Machine
+    ipc = machine["sysbus.ipc"]
+
+    # the doorbell to cpu1 is the ping, the one back to cpu0 the pong
+    def on_cpu1(state):
+        if state:
+            trips.request(machine)
+    def on_cpu0(state):
+        if state:
+            trips.reply(machine)
+
+    ipc.Cpu1IRQ.AddStateChangedHook(on_cpu1)
+    ipc.Cpu0IRQ.AddStateChangedHook(on_cpu0)
+    watch = run_for(seconds)
+    trips.report("IPC doorbell + shared SRAM", seconds, watch)
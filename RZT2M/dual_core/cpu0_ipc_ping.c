@@ -0,0 +1,32 @@
+// cpu0_ipc_ping.c - ping side of the dual-core ping-pong over the IPC mailbox (see ipc_ring.h)
+#include "../ipc_ring.h"
+#include "../sci_driver.h"
+#include "../rzt2m_timer.h"
+
+#define UART0_BASE 0x80001000UL
+
+// pause between two exchanges
+#define PING_PERIOD_MS 500u
+
+int main(void)
+{
+    timer_init();
+    ipc_init(0);
+    irq_init(); // the doorbell ends the WFI in ipc_recv()
+    uart_init(UART0_BASE); // polled, only for the banner
+    uart_puts(UART0_BASE, "CPU0: ping over IPC\n");
+    while (1) {
+        char buf[5] = {0};
+        ipc_send("ping", 4);
+        ipc_recv(buf, 4);
+        // same pacing as cpu0_ping.c, so the two transports run the same workload
+        sleep_ms(PING_PERIOD_MS);
+    }
+    return 0;
+}
+
+void _exit(int status)
+{
+    (void)status;
+    while (1) { }
+}
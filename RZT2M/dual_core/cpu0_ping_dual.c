@@ -0,0 +1,35 @@
+// cpu0_ping_dual.c - ping side of the dual-core ping-pong, runs on cpu0 and talks over SCI0
+#include "../sci_driver.h"
+#include "../rzt2m_timer.h"
+
+#define UART0_BASE 0x80001000UL
+
+// pause between two exchanges
+#define PING_PERIOD_MS 500u
+
+int main(void)
+{
+    timer_init();
+    // interrupt-driven SCI, on this core's GIC: waiting for the peer sleeps in WFI
+    uart_init(UART0_BASE);
+    uart_enable_irq(UART0_BASE);
+    irq_init();
+
+    sleep_ms(1); // let cpu1 boot
+    while (1) {
+        uart_puts(UART0_BASE, "ping\n");
+        char buf[5] = {0};
+        for (int i = 0; i < 4; ++i)
+            buf[i] = uart_getc(UART0_BASE);
+        buf[4] = 0;
+        // Optionally, do something with buf (e.g., check if it's "pong")
+        sleep_ms(PING_PERIOD_MS);
+    }
+    return 0;
+}
+
+void _exit(int status)
+{
+    (void)status;
+    while (1) { }
+}
\ No newline at end of file
@@ -0,0 +1,26 @@
+// cpu1_ipc_pong.c - pong side of the dual-core ping-pong over the IPC mailbox (see ipc_ring.h)
+#include "../ipc_ring.h"
+#include "../rzt2m_timer.h"
+
+// pause between two exchanges
+#define PING_PERIOD_MS 500u
+
+int main(void)
+{
+    timer_init();
+    ipc_init(1);
+    irq_init(); // the doorbell ends the WFI in ipc_recv()
+    while (1) {
+        char buf[5] = {0};
+        ipc_recv(buf, 4);
+        ipc_send("pong", 4);
+        sleep_ms(PING_PERIOD_MS);
+    }
+    return 0;
+}
+
+void _exit(int status)
+{
+    (void)status;
+    while (1) { }
+}
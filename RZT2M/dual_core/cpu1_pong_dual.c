@@ -0,0 +1,33 @@
+// cpu1_pong_dual.c - pong side of the dual-core ping-pong, runs on cpu1 and talks over SCI1
+#include "../sci_driver.h"
+#include "../rzt2m_timer.h"
+
+// pause between two exchanges
+#define PING_PERIOD_MS 500u
+
+#define UART1_BASE 0x80001400UL
+
+int main(void)
+{
+    timer_init();
+    // interrupt-driven SCI, on this core's GIC: waiting for the peer sleeps in WFI
+    uart_init(UART1_BASE);
+    uart_enable_irq(UART1_BASE);
+    irq_init();
+
+    while (1) {
+        char buf[5] = {0};
+        for (int i = 0; i < 4; ++i)
+            buf[i] = uart_getc(UART1_BASE);
+        buf[4] = 0;
+        uart_puts(UART1_BASE, "pong\n");
+        sleep_ms(PING_PERIOD_MS);
+    }
+    return 0;
+}
+
+void _exit(int status)
+{
+    (void)status;
+    while (1) { }
+}
\ No newline at end of file
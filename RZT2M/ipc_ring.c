@@ -0,0 +1,12 @@
+// ipc_ring.c - this core's side of the IPC rings, see ipc_ring.h
+#include "ipc_ring.h"
+
+uint32_t ipc_self;
+
+// Only has to end the receiver's WFI: clears the doorbell, which is a level, and
+// leaves the ring to ipc_recv().
+TCM_TEXT void ipc_doorbell_isr(void* arg)
+{
+    (void)arg;
+    ipc_reg(IPC_DBSTAT(ipc_self)) = IPC_DOORBELL_MSG;
+}
@@ -0,0 +1,133 @@
+// ipc_ring.h - message passing between cpu0 and cpu1 on renesas_rz_t2m_dual.repl
+//
+// Two single-producer/single-consumer byte rings live in the shared SRAM window
+// reported by the IPC block (WINBASE/WINSIZE). Every message is a 16-bit length
+// followed by its payload; after publishing one, the sender rings the receiver's
+// doorbell, whose interrupt ends the receiver's WFI. Needs irq_init() to have run
+// after ipc_init(). The doorbell handler and this core's index are in ipc_ring.c,
+// link it into every image using this.
+#ifndef IPC_RING_H
+#define IPC_RING_H
+
+#include "rzt2m_irq.h"
+
+#define IPC_BASE        0x80300000UL
+#define IPC_DBSET(n)    (0x00 + 0x10 * (n))
+#define IPC_DBSTAT(n)   (0x04 + 0x10 * (n))
+#define IPC_DBEN(n)     (0x08 + 0x10 * (n))
+#define IPC_WINBASE     0x40
+
+#define IPC_DOORBELL_MSG  (1u << 0)
+
+// Cpu0IRQ is gic0@0, Cpu1IRQ gic1@0: the same SPI on either core's GIC
+#define IPC_IRQ         GIC_SPI(0u)
+
+// must be a power of two, two rings plus their headers fit in the 64 KB window
+#define IPC_RING_SIZE   0x4000u
+
+typedef struct {
+    volatile uint32_t head;     // written by the producer only
+    uint32_t pad0[15];          // keep head and tail in separate 64-byte lines
+    volatile uint32_t tail;     // written by the consumer only
+    uint32_t pad1[15];
+    volatile uint8_t data[IPC_RING_SIZE];
+} ipc_ring_t;
+
+// ipc_ring.c
+extern uint32_t ipc_self;
+void ipc_doorbell_isr(void* arg);
+
+#define ipc_reg(ofs)  (*(volatile uint32_t*)(IPC_BASE + (ofs)))
+
+static inline void ipc_dmb(void)
+{
+    __asm__ volatile("dmb" ::: "memory");
+}
+
+// ring n carries messages to cpu n
+static inline ipc_ring_t* ipc_ring(uint32_t to)
+{
+    return (ipc_ring_t*)(ipc_reg(IPC_WINBASE) + to * sizeof(ipc_ring_t));
+}
+
+// The window is zeroed at machine reset, so both rings start empty and either
+// core may send before the other one called ipc_init.
+static inline void ipc_init(uint32_t self)
+{
+    ipc_self = self;
+    ipc_reg(IPC_DBSTAT(self)) = 0xFFFFFFFFu;
+    irq_register(IPC_IRQ, ipc_doorbell_isr, 0);
+    irq_enable(IPC_IRQ);
+    ipc_reg(IPC_DBEN(self)) = IPC_DOORBELL_MSG;
+}
+
+static inline uint32_t ipc_ring_used(const ipc_ring_t* r)
+{
+    return r->head - r->tail;
+}
+
+// Returns 0 on success, -1 if the peer's ring has no room for the message.
+static inline int ipc_send(const void* msg, uint32_t len)
+{
+    uint32_t peer = ipc_self ^ 1u;
+    ipc_ring_t* r = ipc_ring(peer);
+    const uint8_t* src = (const uint8_t*)msg;
+    uint32_t head = r->head;
+
+    if(len > 0xFFFFu || IPC_RING_SIZE - ipc_ring_used(r) < len + 2u) {
+        return -1;
+    }
+    r->data[head++ & (IPC_RING_SIZE - 1u)] = (uint8_t)len;
+    r->data[head++ & (IPC_RING_SIZE - 1u)] = (uint8_t)(len >> 8);
+    for(uint32_t i = 0; i < len; i++) {
+        r->data[head++ & (IPC_RING_SIZE - 1u)] = src[i];
+    }
+    ipc_dmb();              // payload visible before the new head
+    r->head = head;
+    ipc_dmb();
+    ipc_reg(IPC_DBSET(peer)) = IPC_DOORBELL_MSG;
+    return 0;
+}
+
+// Copies the next message (truncated to max bytes) and returns its full length,
+// or -1 when the ring is empty.
+static inline int ipc_try_recv(void* buf, uint32_t max)
+{
+    ipc_ring_t* r = ipc_ring(ipc_self);
+    uint8_t* dst = (uint8_t*)buf;
+    uint32_t tail = r->tail;
+    uint32_t len;
+
+    if(r->head == tail) {
+        return -1;
+    }
+    ipc_dmb();              // head read before the payload
+    len = r->data[tail++ & (IPC_RING_SIZE - 1u)];
+    len |= (uint32_t)r->data[tail++ & (IPC_RING_SIZE - 1u)] << 8;
+    for(uint32_t i = 0; i < len; i++) {
+        uint8_t b = r->data[tail++ & (IPC_RING_SIZE - 1u)];
+        if(i < max) dst[i] = b;
+    }
+    ipc_dmb();
+    r->tail = tail;
+    return (int)len;
+}
+
+// Blocking receive: sleeps in WFI until the doorbell. IRQs are masked around the
+// last look at the ring, a doorbell rung in between still ends the WFI.
+static inline int ipc_recv(void* buf, uint32_t max)
+{
+    ipc_ring_t* r = ipc_ring(ipc_self);
+    int len;
+
+    while((len = ipc_try_recv(buf, max)) < 0) {
+        uint32_t flags = irq_save();
+        if(r->head == r->tail) {
+            cpu_idle();
+        }
+        irq_restore(flags);
+    }
+    return len;
+}
+
+#endif /* IPC_RING_H */
@@ -0,0 +1,24 @@
+// rzt2m_irq.c - interrupt table and dispatch for the RZ/T2M firmware, see rzt2m_irq.h
+#include "rzt2m_irq.h"
+
+irq_entry_t irq_table[IRQ_COUNT];
+volatile uint32_t irq_unhandled;
+
+// Called from rt_irq_entry in startup_rzt2m.s: acknowledges and runs every pending interrupt.
+TCM_TEXT void irq_dispatch(void)
+{
+    for(;;) {
+        uint32_t id;
+        __asm__ volatile("mrc p15, 0, %0, c12, c12, 0" : "=r"(id));    // ICC_IAR1
+        id &= 0xFFFFFFu;
+        if(id >= GIC_SPURIOUS) {
+            return;
+        }
+        if(id < IRQ_COUNT && irq_table[id].handler) {
+            irq_table[id].handler(irq_table[id].arg);
+        } else {
+            irq_unhandled++;
+        }
+        __asm__ volatile("mcr p15, 0, %0, c12, c12, 1" :: "r"(id));     // ICC_EOIR1
+    }
+}
@@ -0,0 +1,148 @@
+// rzt2m_irq.h - interrupt handling for the RZ/T2M firmware
+//
+// startup_rzt2m.s installs the vectors, drops to SVC and sets up the GIC; this is the C
+// side: drivers attach handlers with irq_register() and unmask their lines with
+// irq_enable(), then irq_init() unmasks IRQs on the core. Interrupt IDs are GIC
+// INTIDs: the "gic@N" lines of the .repl files are SPIs, use GIC_SPI(N). The handler
+// table and irq_dispatch() are in rzt2m_irq.c, link it into every image using this.
+//
+// Handlers run in SVC mode on the interrupted stack with IRQs masked. They must not
+// touch the FPU, its registers are not saved on entry.
+#ifndef RZT2M_IRQ_H
+#define RZT2M_IRQ_H
+
+#ifndef _STDINT_H
+#define _STDINT_H
+typedef unsigned char      uint8_t;
+typedef unsigned short     uint16_t;
+typedef unsigned int       uint32_t;
+typedef unsigned long long uint64_t;
+typedef signed char        int8_t;
+typedef signed short       int16_t;
+typedef signed int         int32_t;
+typedef signed long long   int64_t;
+#endif /* _STDINT_H */
+
+// Hot code: goes to ATCM with linker_rzt2m_tcm.ld, stays in .text with linker_rzt2m.ld.
+#define TCM_TEXT        __attribute__((section(".text.tcm")))
+
+// this core's GIC, from the linker script as in startup_rzt2m.s (cpu1 on
+// renesas_rz_t2m_dual.repl has its own at 0x9C000000)
+extern char _gicd_base[], _gicr_base[];
+#define GICD_BASE       ((uint32_t)_gicd_base)
+#define GICR_BASE       ((uint32_t)_gicr_base)
+#define GICR_SGI_BASE   (GICR_BASE + 0x10000u)
+
+#define GICD_IGROUPR    0x0080
+#define GICD_ISENABLER  0x0100
+#define GICD_ICENABLER  0x0180
+#define GICD_IPRIORITYR 0x0400
+#define GICD_ICFGR      0x0C00
+#define GICD_IROUTER    0x6000
+
+#define GIC_SPI(n)      ((n) + 32u)
+#define GIC_SPURIOUS    1020u
+
+// highest SPI on the platform is gic@306
+#define IRQ_COUNT       352u
+#define IRQ_PRIORITY    0xA0u
+
+typedef void (*irq_handler_t)(void* arg);
+
+typedef struct {
+    irq_handler_t handler;
+    void* arg;
+} irq_entry_t;
+
+// rzt2m_irq.c, shared by every file of an image
+extern irq_entry_t irq_table[IRQ_COUNT];
+extern volatile uint32_t irq_unhandled;     // interrupts without a handler
+
+#define gicd_reg(ofs)   (*(volatile uint32_t*)(GICD_BASE + (ofs)))
+#define gicr_sgi(ofs)   (*(volatile uint32_t*)(GICR_SGI_BASE + (ofs)))
+
+static inline void irq_mask(void)
+{
+    __asm__ volatile("cpsid i" ::: "memory");
+}
+
+static inline void irq_unmask(void)
+{
+    __asm__ volatile("cpsie i" ::: "memory");
+}
+
+// masks IRQs and returns the previous CPSR for irq_restore()
+static inline uint32_t irq_save(void)
+{
+    uint32_t cpsr;
+    __asm__ volatile("mrs %0, cpsr\n"
+                     "cpsid i" : "=r"(cpsr) :: "memory");
+    return cpsr;
+}
+
+static inline void irq_restore(uint32_t cpsr)
+{
+    if((cpsr & (1u << 7)) == 0u) {
+        irq_unmask();
+    }
+}
+
+// startup_rzt2m.s: WFI, see there for how to wait without missing a wake-up
+void cpu_idle(void);
+
+// rzt2m_irq.c, called from rt_irq_entry in startup_rzt2m.s
+void irq_dispatch(void);
+
+static inline void irq_register(uint32_t id, irq_handler_t handler, void* arg)
+{
+    if(id >= IRQ_COUNT) {
+        return;
+    }
+    irq_table[id].arg = arg;
+    irq_table[id].handler = handler;
+}
+
+static inline void irq_enable(uint32_t id)
+{
+    uint32_t bit = 1u << (id & 31u);
+
+    if(id < 32u) {
+        gicr_sgi(GICD_IGROUPR) |= bit;
+        *(volatile uint8_t*)(GICR_SGI_BASE + GICD_IPRIORITYR + id) = IRQ_PRIORITY;
+        gicr_sgi(GICD_ISENABLER) = bit;
+        return;
+    }
+    uint32_t mpidr;
+    __asm__ volatile("mrc p15, 0, %0, c0, c0, 5" : "=r"(mpidr));
+    gicd_reg(GICD_IGROUPR + 4u * (id / 32u)) |= bit;
+    *(volatile uint8_t*)(GICD_BASE + GICD_IPRIORITYR + id) = IRQ_PRIORITY;
+    gicd_reg(GICD_IROUTER + 8u * id) = mpidr & 0xFFFFFFu;          // to this core
+    gicd_reg(GICD_IROUTER + 8u * id + 4u) = 0;
+    gicd_reg(GICD_ISENABLER + 4u * (id / 32u)) = bit;
+}
+
+// SPIs are level-sensitive out of reset; pulsed sources (e.g. SCI TXI) need the edge setting.
+static inline void irq_set_edge(uint32_t id)
+{
+    if(id < 32u) {
+        return;
+    }
+    gicd_reg(GICD_ICFGR + 4u * (id / 16u)) |= 2u << (2u * (id & 15u));
+}
+
+static inline void irq_disable(uint32_t id)
+{
+    uint32_t bit = 1u << (id & 31u);
+    if(id < 32u) {
+        gicr_sgi(GICD_ICENABLER) = bit;
+    } else {
+        gicd_reg(GICD_ICENABLER + 4u * (id / 32u)) = bit;
+    }
+}
+
+static inline void irq_init(void)
+{
+    irq_unmask();
+}
+
+#endif /* RZT2M_IRQ_H */
@@ -0,0 +1,92 @@
+// rzt2m_timer.h - sleeps and timeouts on the ARM generic timer ("timer" in the .repl files)
+//
+// Time is the EL1 physical counter, CNTPCT, at 20 MHz. A sleep programs the EL1 physical
+// timer's compare value and waits in WFI until it fires on PPI 30, so it is exact in
+// virtual time, costs a handful of instructions however long it is, and lets Renode
+// skip the idle period. Call timer_init() once; sleeping works with IRQs masked too.
+#ifndef RZT2M_TIMER_H
+#define RZT2M_TIMER_H
+
+#include "rzt2m_irq.h"
+
+#define TIMER_HZ            20000000u
+#define TIMER_PPI           30u         // EL1PhysicalTimerIRQ -> gic#0@30
+
+#define CNTP_CTL_ENABLE     (1u << 0)
+
+static inline uint64_t timer_now(void)
+{
+    uint32_t lo, hi;
+    __asm__ volatile("isb\n"
+                     "mrrc p15, 0, %0, %1, c14" : "=r"(lo), "=r"(hi));         // CNTPCT
+    return ((uint64_t)hi << 32) | lo;
+}
+
+static inline void timer_arm(uint64_t deadline)
+{
+    __asm__ volatile("mcrr p15, 2, %0, %1, c14" ::
+                     "r"((uint32_t)deadline), "r"((uint32_t)(deadline >> 32)));  // CNTP_CVAL
+    __asm__ volatile("mcr p15, 0, %0, c14, c2, 1\n"                           // CNTP_CTL
+                     "isb" :: "r"(CNTP_CTL_ENABLE) : "memory");
+}
+
+static inline void timer_disarm(void)
+{
+    __asm__ volatile("mcr p15, 0, %0, c14, c2, 1" :: "r"(0u) : "memory");
+}
+
+// the interrupt only has to end the WFI, sleepers check their deadline themselves
+TCM_TEXT static inline void timer_isr(void* arg)
+{
+    (void)arg;
+    timer_disarm();
+}
+
+static inline void timer_init(void)
+{
+    timer_disarm();
+    irq_register(TIMER_PPI, timer_isr, 0);
+    irq_enable(TIMER_PPI);
+}
+
+static inline uint64_t timer_us_to_ticks(uint32_t us)
+{
+    return (uint64_t)us * (TIMER_HZ / 1000000u);
+}
+
+// Deadline for timeout_expired(), us microseconds from now.
+static inline uint64_t timeout_after_us(uint32_t us)
+{
+    return timer_now() + timer_us_to_ticks(us);
+}
+
+static inline int timeout_expired(uint64_t deadline)
+{
+    return timer_now() >= deadline;
+}
+
+// Other interrupts may end the WFI early, the timer is then armed again.
+TCM_TEXT static inline void sleep_until(uint64_t deadline)
+{
+    while(!timeout_expired(deadline)) {
+        uint32_t flags = irq_save();
+        timer_arm(deadline);
+        if(!timeout_expired(deadline)) {
+            cpu_idle();
+        }
+        irq_restore(flags);
+    }
+    timer_disarm();
+}
+
+static inline void sleep_us(uint32_t us)
+{
+    sleep_until(timeout_after_us(us));
+}
+
+static inline void sleep_ms(uint32_t ms)
+{
+    sleep_until(timer_now() + (uint64_t)ms * (TIMER_HZ / 1000u));
+}
+
+#endif /* RZT2M_TIMER_H */
@@ -0,0 +1,4 @@
+// sci_driver.c - SCI port state for the RZ/T2M firmware, see sci_driver.h
+#include "sci_driver.h"
+
+sci_port_t sci_ports[SCI_PORTS];
@@ -0,0 +1,271 @@
+// sci_driver.h - SCI (UART) driver shared by the RZ/T2M firmware
+//
+// Ports are addressed by their base address. Out of reset a port is polled: uart_putc
+// waits for room in the TX fifo (FTSR.T) and uart_getc for data in the RX fifo (FRSR.R). After
+// uart_enable_irq() both directions go through single-producer/single-consumer rings:
+// the RXI handler fills the RX ring from the fifo, the TXI handler drains the TX ring
+// into it, and the caller only touches the rings. Needs irq_init() to have run;
+// blocking calls on such a port sleep in WFI instead of spinning. The port state is in
+// sci_driver.c, link it into every image using this.
+#ifndef SCI_DRIVER_H
+#define SCI_DRIVER_H
+
+#include "rzt2m_irq.h"
+
+#define SCI0_BASE       0x80001000UL
+#define SCI1_BASE       0x80001400UL
+#define SCI2_BASE       0x80001800UL
+#define SCI3_BASE       0x80001C00UL
+#define SCI4_BASE       0x80002000UL
+#define SCI5_BASE       0x81001000UL
+#define SCI_PORTS       6u
+
+#define SCI_RDR         0x00
+#define SCI_TDR         0x04
+#define SCI_CCR0        0x08
+#define SCI_CSR         0x48
+#define SCI_FRSR        0x50
+#define SCI_FTSR        0x54
+#define SCI_CFCLR       0x68
+
+#define CCR0_RE         (1u << 0)
+#define CCR0_TE         (1u << 4)
+#define CCR0_RIE        (1u << 16)
+#define CCR0_TIE        (1u << 20)
+#define CSR_ORER        (1u << 24)
+#define CSR_TEND        (1u << 30)
+#define CFCLR_ORERC     (1u << 24)
+#define FRSR_DR         (1u << 0)
+#define FRSR_R(v)       (((v) >> 8) & 0x3Fu)    // bytes in the RX fifo
+#define SCI_FIFO_DEPTH  16u
+
+// RXI of SCIn is gic@(289 + 3n), TXI the line after it
+#define SCI_RXI(n)      GIC_SPI(289u + 3u * (n))
+#define SCI_TXI(n)      GIC_SPI(290u + 3u * (n))
+
+// per direction and port, must be a power of two
+#ifndef SCI_RING_SIZE
+#define SCI_RING_SIZE   256u
+#endif
+
+typedef struct {
+    volatile uint32_t head;     // written by the producer only
+    volatile uint32_t tail;     // written by the consumer only
+    volatile uint8_t data[SCI_RING_SIZE];
+} sci_ring_t;
+
+typedef struct {
+    uint32_t base;
+    int irq_driven;
+    uint32_t rx_dropped;        // RX ring was full
+    uint32_t rx_overruns;       // RX fifo was full (ORER), the SCI dropped the data
+    sci_ring_t rx;              // RXI -> caller
+    sci_ring_t tx;              // caller -> TXI
+} sci_port_t;
+
+// sci_driver.c, shared by every file of an image
+extern sci_port_t sci_ports[SCI_PORTS];
+
+#define sci_reg(base, ofs)  (*(volatile uint32_t*)((base) + (ofs)))
+
+// the ring indices are shared with a handler on the same core, a compiler barrier is enough
+static inline void sci_barrier(void)
+{
+    __asm__ volatile("" ::: "memory");
+}
+
+static inline uint32_t sci_index(uint32_t base)
+{
+    return base == SCI5_BASE ? 5u : (base - SCI0_BASE) >> 10;
+}
+
+static inline sci_port_t* sci_port(uint32_t base)
+{
+    return &sci_ports[sci_index(base)];
+}
+
+static inline uint32_t sci_ring_used(const sci_ring_t* r)
+{
+    return r->head - r->tail;
+}
+
+// Sleeps until the next interrupt unless *index has already moved on from seen. IRQs
+// are masked around the check, an interrupt landing in between still ends the WFI.
+TCM_TEXT static inline void sci_wait(const volatile uint32_t* index, uint32_t seen)
+{
+    uint32_t flags = irq_save();
+    if(*index == seen) {
+        cpu_idle();
+    }
+    irq_restore(flags);
+}
+
+// ORER stops reception until it is cleared; whatever it dropped is lost anyway.
+TCM_TEXT static inline void sci_clear_overrun(uint32_t base)
+{
+    if(sci_reg(base, SCI_CSR) & CSR_ORER) {
+        sci_reg(base, SCI_CFCLR) = CFCLR_ORERC;
+        sci_port(base)->rx_overruns++;
+    }
+}
+
+TCM_TEXT static inline void sci_rx_isr(void* arg)
+{
+    sci_port_t* p = (sci_port_t*)arg;
+    uint32_t head = p->rx.head;
+    uint32_t n;
+
+    // DR stays set while the fifo is below the trigger level, so it cannot end the loop:
+    // read what FRSR.R counts and look again for bytes that arrived meanwhile
+    while((n = FRSR_R(sci_reg(p->base, SCI_FRSR))) != 0u) {
+        while(n--) {
+            uint8_t c = (uint8_t)sci_reg(p->base, SCI_RDR);
+            if(head - p->rx.tail == SCI_RING_SIZE) {
+                p->rx_dropped++;
+                continue;
+            }
+            p->rx.data[head++ & (SCI_RING_SIZE - 1u)] = c;
+        }
+    }
+    sci_clear_overrun(p->base);
+    sci_barrier();
+    p->rx.head = head;
+}
+
+TCM_TEXT static inline void sci_tx_isr(void* arg)
+{
+    sci_port_t* p = (sci_port_t*)arg;
+    uint32_t tail = p->tx.tail;
+
+    while(tail != p->tx.head && (sci_reg(p->base, SCI_FTSR) & 0x3Fu) < SCI_FIFO_DEPTH) {
+        sci_reg(p->base, SCI_TDR) = p->tx.data[tail++ & (SCI_RING_SIZE - 1u)];
+    }
+    sci_barrier();
+    p->tx.tail = tail;
+    if(tail == p->tx.head) {
+        // nothing left to send: mask TXI, in timed mode it stays asserted while the fifo has room
+        sci_reg(p->base, SCI_CCR0) &= ~CCR0_TIE;
+    }
+}
+
+static inline void uart_init(uint32_t base)
+{
+    sci_port_t* p = sci_port(base);
+    p->base = base;
+    p->irq_driven = 0;
+    sci_reg(base, SCI_CCR0) = CCR0_RE | CCR0_TE;
+}
+
+static inline void uart_enable_irq(uint32_t base)
+{
+    uint32_t n = sci_index(base);
+    sci_port_t* p = &sci_ports[n];
+
+    p->base = base;
+    p->rx.head = p->rx.tail = 0;
+    p->tx.head = p->tx.tail = 0;
+    p->irq_driven = 1;
+    irq_register(SCI_RXI(n), sci_rx_isr, p);
+    irq_register(SCI_TXI(n), sci_tx_isr, p);
+    // TXI is a level in timed mode but one edge per TDR write in instant mode
+    irq_set_edge(SCI_TXI(n));
+    irq_enable(SCI_RXI(n));
+    irq_enable(SCI_TXI(n));
+    sci_reg(base, SCI_CCR0) |= CCR0_RE | CCR0_TE | CCR0_RIE;
+}
+
+TCM_TEXT static inline void uart_putc(uint32_t base, char c)
+{
+    sci_port_t* p = sci_port(base);
+
+    if(!p->irq_driven) {
+        while((sci_reg(base, SCI_FTSR) & 0x3Fu) >= SCI_FIFO_DEPTH) { }
+        sci_reg(base, SCI_TDR) = (uint32_t)c & 0xFF;
+        return;
+    }
+    while(sci_ring_used(&p->tx) == SCI_RING_SIZE) {
+        sci_wait(&p->tx.tail, p->tx.head - SCI_RING_SIZE);
+    }
+    p->tx.data[p->tx.head & (SCI_RING_SIZE - 1u)] = (uint8_t)c;
+    sci_barrier();
+    p->tx.head++;
+    sci_reg(base, SCI_CCR0) |= CCR0_TIE;
+}
+
+static inline void uart_puts(uint32_t base, const char *s)
+{
+    while (*s) {
+        if (*s == '\n') uart_putc(base, '\r');
+        uart_putc(base, *s++);
+    }
+}
+
+static inline void uart_write(uint32_t base, const void* buf, uint32_t len)
+{
+    const char* s = (const char*)buf;
+    for(uint32_t i = 0; i < len; i++) {
+        uart_putc(base, s[i]);
+    }
+}
+
+// Returns the next received byte, or -1 if there is none.
+TCM_TEXT static inline int uart_try_getc(uint32_t base)
+{
+    sci_port_t* p = sci_port(base);
+    uint8_t c;
+
+    if(!p->irq_driven) {
+        if(FRSR_R(sci_reg(base, SCI_FRSR)) == 0u) {
+            sci_clear_overrun(base);
+            return -1;
+        }
+        return (int)(sci_reg(base, SCI_RDR) & 0xFF);
+    }
+    if(p->rx.head == p->rx.tail) {
+        return -1;
+    }
+    sci_barrier();
+    c = p->rx.data[p->rx.tail & (SCI_RING_SIZE - 1u)];
+    sci_barrier();
+    p->rx.tail++;
+    return c;
+}
+
+TCM_TEXT static inline char uart_getc(uint32_t base)
+{
+    sci_port_t* p = sci_port(base);
+    int c;
+    while((c = uart_try_getc(base)) < 0) {
+        if(p->irq_driven) {
+            sci_wait(&p->rx.head, p->rx.tail);
+        }
+    }
+    return (char)c;
+}
+
+// Reads up to the next '\n' (dropped, as are '\r's), returns the line length.
+static inline int uart_readline(uint32_t base, char* buf, int max)
+{
+    int i = 0;
+    char c;
+    while(i < max - 1) {
+        c = uart_getc(base);
+        if(c == '\r') continue;
+        if(c == '\n') break;
+        buf[i++] = c;
+    }
+    buf[i] = '\0';
+    return i;
+}
+
+// Waits until everything queued has left the transmitter.
+static inline void uart_flush(uint32_t base)
+{
+    sci_port_t* p = sci_port(base);
+    while(p->irq_driven && p->tx.head != p->tx.tail) {
+        sci_wait(&p->tx.tail, p->tx.tail);
+    }
+    while((sci_reg(base, SCI_CSR) & CSR_TEND) == 0u) { }
+}
+
+#endif /* SCI_DRIVER_H */
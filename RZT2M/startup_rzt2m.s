@@ -1,14 +1,82 @@
-    .section .text
+/* RZ/T2M (Cortex-R52) startup and minimal runtime: exception vectors, Hyp -> SVC,
+   load image copies, GICv3 setup, IRQ entry and the WFI idle routine. IRQs stay
+   masked until the firmware has registered its handlers and calls irq_init()
+   (rzt2m_irq.h). The runtime code goes to .text.tcm, next to the vectors, which
+   linker_rzt2m_tcm.ld places in ATCM. */
+    .syntax unified
+    .cpu cortex-r52
+    .arm
+
+    .section .vectors, "ax"
+    .global _vectors
+    .balign 32
+_vectors:
+    b     _start
+    b     rt_undef_handler
+    b     rt_svc_handler
+    b     rt_prefetch_abort_handler
+    b     rt_data_abort_handler
+    b     rt_fault
+    b     rt_irq_entry
+    b     rt_fiq_handler
+
+/* everything up to main(): the XIP image (linker_rzt2m_xip.ld) starts with it */
+    .section .text.boot, "ax"
     .global _start
 
 _start:
+    /* the R52 leaves reset in Hyp mode, where interrupts routed to EL1 are never taken */
+    mrs   r0, cpsr
+    and   r1, r0, #0x1f
+    cmp   r1, #0x1a
+    bne   1f
+    mov   r1, #0xf
+    mcr   p15, 4, r1, c12, c9, 5      /* ICC_HSRE: GIC system registers usable at EL1 */
+    mov   r1, #3
+    mcr   p15, 4, r1, c14, c1, 0      /* CNTHCTL: EL1 physical counter and timer */
+    bic   r0, r0, #0x1f
+    orr   r0, r0, #0xd3               /* SVC, IRQ and FIQ masked */
+    msr   spsr_hyp, r0
+    adr   r1, 1f
+    msr   elr_hyp, r1
+    isb
+    eret
+1:
     ldr   r0, =_stack_top
     mov   sp, r0
 
+    ldr   r0, =_tcm_load
+    ldr   r1, =_tcm_start
+    ldr   r2, =_tcm_end
+    bl    copy_words
+    ldr   r0, =_data_load
+    ldr   r1, =_data_start
+    ldr   r2, =_data_end
+    bl    copy_words
+    dsb
+    isb
+
     bl    zero_bss
+    ldr   r0, =_vectors
+    mcr   p15, 0, r0, c12, c0, 0      /* VBAR */
+    isb
+    bl    gic_init
     bl    main
 
-1:  b     1b
+    cpsid if
+2:  wfi
+    b     2b
+
+/* r0: load image, r1..r2: where it runs; skipped when loaded in place */
+copy_words:
+    cmp   r0, r1
+    bxeq  lr
+0:
+    cmp   r1, r2
+    bxcs  lr
+    ldr   r3, [r0], #4
+    str   r3, [r1], #4
+    b     0b
 
 zero_bss:
     ldr   r0, =_bss_start
@@ -23,8 +91,97 @@ zero_bss:
 1:
     bx    lr
 
+/* Distributor (affinity routing, group 1 on), this core's redistributor awake,
+   CPU interface through the system registers with every priority unmasked.
+   The GIC of the core comes from the linker script (_gicd_base/_gicr_base). */
+gic_init:
+    ldr   r0, =_gicd_base
+    mov   r1, #0x10                   /* GICD_CTLR.ARE */
+    str   r1, [r0]
+    orr   r1, r1, #0x2                /* GICD_CTLR.EnableGrp1 */
+    str   r1, [r0]
+
+    ldr   r0, =_gicr_base
+    ldr   r1, [r0, #0x14]             /* GICR_WAKER */
+    bic   r1, r1, #0x2                /* ProcessorSleep */
+    str   r1, [r0, #0x14]
+0:
+    ldr   r1, [r0, #0x14]
+    tst   r1, #0x4                    /* ChildrenAsleep */
+    bne   0b
+
+    mov   r1, #0x7
+    mcr   p15, 0, r1, c12, c12, 5     /* ICC_SRE */
+    isb
+    mov   r1, #0xff
+    mcr   p15, 0, r1, c4, c6, 0       /* ICC_PMR */
+    mov   r1, #0
+    mcr   p15, 0, r1, c12, c12, 3     /* ICC_BPR1 */
+    mov   r1, #1
+    mcr   p15, 0, r1, c12, c12, 7     /* ICC_IGRPEN1 */
+    isb
+    bx    lr
+
+    .section .text.tcm, "ax"
+
+/* IRQs are handled in SVC mode: LR_irq and SPSR_irq go onto the SVC stack, so the
+   IRQ mode needs no stack of its own. irq_dispatch (rzt2m_irq.c) acknowledges and
+   runs the handlers; the FPU registers are not saved. */
+    .global rt_irq_entry
+rt_irq_entry:
+    sub   lr, lr, #4
+    srsdb sp!, #0x13
+    cps   #0x13
+    push  {r0-r3, r12, lr}
+    and   r1, sp, #4                  /* 8-byte align the stack for the C call */
+    sub   sp, sp, r1
+    push  {r1, r2}
+    bl    irq_dispatch
+    pop   {r1, r2}
+    add   sp, sp, r1
+    pop   {r0-r3, r12, lr}
+    rfeia sp!
+
+/* Sleeps until an interrupt is pending, even with IRQs masked: mask, check for
+   work, cpu_idle(), unmask, so that an interrupt in between is not missed. */
+    .global cpu_idle
+cpu_idle:
+    dsb
+    wfi
+    bx    lr
+
+/* Unhandled exceptions park the core; any of them can be overridden from C. */
+    .global rt_fault
+rt_fault:
+    cpsid if
+0:  wfi
+    b     0b
+
+    .weak rt_undef_handler
+    .set  rt_undef_handler, rt_fault
+    .weak rt_svc_handler
+    .set  rt_svc_handler, rt_fault
+    .weak rt_prefetch_abort_handler
+    .set  rt_prefetch_abort_handler, rt_fault
+    .weak rt_data_abort_handler
+    .set  rt_data_abort_handler, rt_fault
+    .weak rt_fiq_handler
+    .set  rt_fiq_handler, rt_fault
+
+/* for images without rzt2m_irq.c, which never unmask IRQs */
+    .weak irq_dispatch
+irq_dispatch:
+    bx    lr
+
     .extern main
     .extern _bss_start
     .extern _bss_end
     .extern _stack_top
-    
+    .extern _tcm_load
+    .extern _tcm_start
+    .extern _tcm_end
+    .extern _data_load
+    .extern _data_start
+    .extern _data_end
+    .extern _gicd_base
+    .extern _gicr_base
@@ -0,0 +1,112 @@
+# Synchronisation helpers for the multi-machine RZ/T2M scripts (UARTHub / GPIOConnector links).
+# Load with `include @.../quantum_sync.py`, every `mc_*` function becomes a monitor command.
+#
+# Machines only see each other's bytes and edges at synchronisation points, so the
+# global quantum bounds both the link latency and how often all machines have to meet.
+# Both modes are opt-in: "none" leaves Renode's quantum alone, so arrival times match a
+# run without these helpers. The adaptive mode keeps the quantum small while there is
+# traffic and doubles it at every sync point that passed without any, up to a ceiling.
+# Delivery still happens at sync points in the same order, only their spacing changes.
+
+from Antmicro.Renode.Core import EmulationManager
+from Antmicro.Renode.Time import TimeInterval
+from Antmicro.Renode.Peripherals.UART import IUART
+from Antmicro.Renode.Peripherals.GPIOPort import BaseGPIOPort
+
+def machines():
+    return list(EmulationManager.Instance.CurrentEmulation.Machines)
+
+def time_source():
+    return EmulationManager.Instance.CurrentEmulation.MasterTimeSource
+
+def interval(seconds):
+    return TimeInterval.FromMicroseconds(long(float(str(seconds)) * 1e6))
+
+class AdaptiveQuantum(object):
+    def __init__(self, minimum, maximum):
+        self.minimum = minimum
+        self.maximum = maximum
+        self.traffic = False
+        self.syncs = 0
+        self.uarts = []
+        self.gpios = []
+        self.edges = 0
+
+    def on_char(self, _):
+        self.traffic = True
+
+    def gpio_edges(self):
+        return sum(g.EdgesEmitted for g in self.gpios)
+
+    def on_sync(self, _):
+        self.syncs += 1
+        edges = self.gpio_edges()
+        source = time_source()
+        if self.traffic or edges != self.edges:
+            source.Quantum = self.minimum
+        elif source.Quantum.Ticks < self.maximum.Ticks:
+            source.Quantum = TimeInterval.FromTicks(min(source.Quantum.Ticks * 2, self.maximum.Ticks))
+        self.traffic = False
+        self.edges = edges
+
+    def install(self):
+        for machine in machines():
+            for uart in machine.GetPeripheralsOfType[IUART]():
+                uart.CharReceived += self.on_char
+                self.uarts.append(uart)
+            for gpio in machine.GetPeripheralsOfType[BaseGPIOPort]():
+                # only Renesas_GPIO counts the edges it drives
+                if hasattr(gpio, "EdgesEmitted"):
+                    self.gpios.append(gpio)
+        self.edges = self.gpio_edges()
+        time_source().Quantum = self.minimum
+        time_source().SyncHook += self.on_sync
+
+    def uninstall(self):
+        time_source().SyncHook -= self.on_sync
+        for uart in self.uarts:
+            uart.CharReceived -= self.on_char
+
+# the scenarios include this file again and again, an installed controller has to survive that
+try:
+    adaptive
+except NameError:
+    adaptive = None
+
+def mc_sync_mode(mode, quantum="0.0001", max_quantum="0.01"):
+    """sync_mode none|fixed|adaptive [quantum s] [max quantum s] - call after all machines and connectors exist"""
+    global adaptive
+    if adaptive is not None:
+        adaptive.uninstall()
+        adaptive = None
+
+    if str(mode) == "none":
+        print("sync none, quantum %s" % time_source().Quantum)
+        return
+    if str(mode) == "adaptive":
+        adaptive = AdaptiveQuantum(interval(quantum), interval(max_quantum))
+        adaptive.install()
+    else:
+        time_source().Quantum = interval(quantum)
+    print("sync %s, quantum %s s" % (mode, quantum))
+
+def mc_sync_stats():
+    """sync_stats - sync points seen and current quantum in adaptive mode"""
+    if adaptive is None:
+        print("sync fixed or none, quantum %s" % time_source().Quantum)
+    else:
+        print("sync adaptive, %d sync points, quantum now %s" % (adaptive.syncs, time_source().Quantum))
+
+def mc_sync_benchmark(label, seconds=10):
+    """sync_benchmark label [virtual seconds] - runs the emulation and reports host s per simulated s"""
+    # Continues from wherever the emulation is: to compare modes, Clear and rebuild the
+    # scenario before each call so that every run starts from reset
+    from System.Diagnostics import Stopwatch
+    syncs = adaptive.syncs if adaptive is not None else 0
+    watch = Stopwatch.StartNew()
+    monitor.Parse('emulation RunFor "%s"' % str(seconds))
+    watch.Stop()
+    line = "%s: %.3f host s per simulated s" % (label, watch.Elapsed.TotalSeconds / float(str(seconds)))
+    if adaptive is not None:
+        line += ", %d sync points, quantum now %s" % (adaptive.syncs - syncs, time_source().Quantum)
+    print(line)
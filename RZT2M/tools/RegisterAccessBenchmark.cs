@@ -0,0 +1,109 @@
+//
+// Copyright (c) 2010-2023 Antmicro
+//
+// This file is licensed under the MIT License.
+// Full license text is available in 'licenses/MIT.txt'.
+//
+using System.Diagnostics;
+using Antmicro.Renode.Exceptions;
+
+namespace Antmicro.Renode.Peripherals.Bus
+{
+    // Host cost of register accesses, timed in C# rather than from a script or guest loop:
+    //   include @tools/RegisterAccessBenchmark.cs
+    //   sysbus.sci0 BenchmarkRegisterAccess "r32" 0x50
+    // The peripheral's Read*/Write* methods are called back to back, cycling over `count`
+    // registers of the access width from `offset`; the same loop reading a host array is
+    // timed as well and subtracted, so what is left is the model's own dispatch cost.
+    public static class RegisterAccessBenchmarkExtensions
+    {
+        // access is r8, w8, r16, w16, r32 or w32
+        public static string BenchmarkRegisterAccess(this IBusPeripheral peripheral, string access, long offset,
+            int count = 1, int iterations = 1000000, uint value = 0)
+        {
+            if(count < 1 || iterations < 1)
+            {
+                throw new RecoverableException("count and iterations have to be positive");
+            }
+
+            var watch = Stopwatch.StartNew();
+            switch(access)
+            {
+            case "r8":
+                var bytes = As<IBytePeripheral>(peripheral, access);
+                for(var i = 0; i < iterations; i++)
+                {
+                    sink += bytes.ReadByte(offset + i % count);
+                }
+                break;
+            case "w8":
+                var byteTarget = As<IBytePeripheral>(peripheral, access);
+                for(var i = 0; i < iterations; i++)
+                {
+                    byteTarget.WriteByte(offset + i % count, (byte)value);
+                }
+                break;
+            case "r16":
+                var words = As<IWordPeripheral>(peripheral, access);
+                for(var i = 0; i < iterations; i++)
+                {
+                    sink += words.ReadWord(offset + 2 * (i % count));
+                }
+                break;
+            case "w16":
+                var wordTarget = As<IWordPeripheral>(peripheral, access);
+                for(var i = 0; i < iterations; i++)
+                {
+                    wordTarget.WriteWord(offset + 2 * (i % count), (ushort)value);
+                }
+                break;
+            case "r32":
+                var doubleWords = As<IDoubleWordPeripheral>(peripheral, access);
+                for(var i = 0; i < iterations; i++)
+                {
+                    sink += doubleWords.ReadDoubleWord(offset + 4 * (i % count));
+                }
+                break;
+            case "w32":
+                var doubleWordTarget = As<IDoubleWordPeripheral>(peripheral, access);
+                for(var i = 0; i < iterations; i++)
+                {
+                    doubleWordTarget.WriteDoubleWord(offset + 4 * (i % count), value);
+                }
+                break;
+            default:
+                throw new RecoverableException($"Unknown access '{access}', expected r8, w8, r16, w16, r32 or w32");
+            }
+            watch.Stop();
+
+            var control = TimeControlLoop(count, iterations);
+            var nanoseconds = (watch.Elapsed.TotalMilliseconds - control) * 1e6 / iterations;
+            return $"{access} 0x{offset:X} x{count}: {nanoseconds:F1} host ns per access ({iterations} accesses, control loop {control * 1e6 / iterations:F1} ns)";
+        }
+
+        // the same loop shape over a host array, i.e. everything but the peripheral call
+        private static double TimeControlLoop(int count, int iterations)
+        {
+            var memory = new uint[count];
+            var watch = Stopwatch.StartNew();
+            for(var i = 0; i < iterations; i++)
+            {
+                sink += memory[i % count];
+            }
+            watch.Stop();
+            return watch.Elapsed.TotalMilliseconds;
+        }
+
+        private static T As<T>(IBusPeripheral peripheral, string access) where T : class
+        {
+            if(!(peripheral is T target))
+            {
+                throw new RecoverableException($"The peripheral does not support {access} accesses");
+            }
+            return target;
+        }
+
+        // keeps the reads observable so they are not optimized away
+        private static ulong sink;
+    }
+}
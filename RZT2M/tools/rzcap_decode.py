@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+"""Decode UART captures written by `StartCapture` (UARTCapture.cs) into text or CSV.
+
+usage: rzcap_decode.py capture.rzcap [--csv] [--source NAME] [--sort]
+
+Text output prints one line per byte: virtual time, source, direction and the byte
+(printable characters as-is, the rest as hex). CSV output has the columns
+time_us,source,direction,byte. Machines on different host threads append to the
+file as they run, --sort orders the records by virtual time.
+"""
+
+import argparse
+import csv
+import struct
+import sys
+
+MAGIC = b"RZTCAP"
+HEADER_SIZE = 8
+KIND_SOURCE, KIND_RX, KIND_TX = 0, 1, 2
+BYTE_RECORD = struct.Struct("<QBB")
+
+
+def records(data):
+    if data[:len(MAGIC)] != MAGIC:
+        raise ValueError("not a capture file (bad magic)")
+    if data[len(MAGIC)] != 1:
+        raise ValueError("unsupported capture version %d" % data[len(MAGIC)])
+
+    sources = {}
+    pos = HEADER_SIZE
+    while pos < len(data):
+        kind = data[pos]
+        pos += 1
+        if kind == KIND_SOURCE:
+            ident, length = data[pos], data[pos + 1]
+            sources[ident] = data[pos + 2:pos + 2 + length].decode("utf-8", "replace")
+            pos += 2 + length
+        elif kind in (KIND_RX, KIND_TX):
+            if pos + BYTE_RECORD.size > len(data):
+                break  # truncated tail, e.g. the emulator was killed mid-flush
+            timestamp, ident, value = BYTE_RECORD.unpack_from(data, pos)
+            pos += BYTE_RECORD.size
+            yield timestamp, sources.get(ident, "#%d" % ident), "RX" if kind == KIND_RX else "TX", value
+        else:
+            raise ValueError("unknown record kind %d at offset %d" % (kind, pos - 1))
+
+
+def show(value):
+    char = chr(value)
+    return char if char.isprintable() else "0x%02X" % value
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("capture")
+    parser.add_argument("--csv", action="store_true", help="write CSV instead of text")
+    parser.add_argument("--source", help="only records of this source (machine:peripheral)")
+    parser.add_argument("--sort", action="store_true", help="order records by virtual time")
+    args = parser.parse_args()
+
+    with open(args.capture, "rb") as f:
+        data = f.read()
+
+    out = csv.writer(sys.stdout) if args.csv else None
+    if out:
+        out.writerow(["time_us", "source", "direction", "byte"])
+    decoded = records(data)
+    if args.sort:
+        decoded = sorted(decoded, key=lambda record: record[0])
+    for timestamp, source, direction, value in decoded:
+        if args.source and source != args.source:
+            continue
+        if out:
+            out.writerow([timestamp, source, direction, value])
+        else:
+            print("%12.6f s  %-28s %s  %s" % (timestamp / 1e6, source, direction, show(value)))
+
+
+if __name__ == "__main__":
+    main()
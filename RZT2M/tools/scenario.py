@@ -0,0 +1,50 @@
+# Shared helpers for the .resc scenarios: GUI analyzers or headless file sinks, and how the run ends.
+# Load with `include @.../scenario.py`, every `mc_*` function becomes a monitor command.
+#
+#   terminal "sysbus.sci0" $headless $log_dir   showAnalyzer, or a buffered file backend when headless
+#   scenario_run $headless $run_for             StartAll, or a timed RunFor when headless / $run_for is set;
+#                                               $run_for "0" only builds the scenario, for benchmarks
+#
+# For CI: set $headless=true (and optionally $run_for) before including a scenario, run
+# Renode with --disable-xwt and issue `quit` once the script returns.
+
+import os
+from System.Diagnostics import Stopwatch
+from Antmicro.Renode.Core import EmulationManager
+
+DEFAULT_HEADLESS_RUN = "5"
+
+def flag(value):
+    return str(value).lower() in ("true", "1", "yes")
+
+def machine_name():
+    found, name = EmulationManager.Instance.CurrentEmulation.TryGetMachineName(monitor.Machine)
+    return name if found else "machine"
+
+def mc_terminal(uart, headless=False, log_dir="logs"):
+    """terminal uart [headless] [log dir]"""
+    uart = str(uart)
+    if not flag(headless):
+        monitor.Parse('showAnalyzer %s' % uart)
+        return
+    log_dir = str(log_dir).lstrip("@")
+    if not os.path.isdir(log_dir):
+        os.makedirs(log_dir)
+    path = os.path.join(log_dir, "%s_%s.log" % (machine_name(), uart.replace("sysbus.", "")))
+    # buffered, flushed by Renode when the backend is closed
+    monitor.Parse('%s CreateFileBackend @%s false' % (uart, path))
+
+def mc_scenario_run(headless=False, run_for=""):
+    """scenario_run [headless] [virtual seconds] - interactive StartAll, or a bounded, timed run"""
+    run_for = str(run_for)
+    if run_for == "0":
+        return
+    if not flag(headless) and run_for == "":
+        monitor.Parse('emulation StartAll')
+        return
+    seconds = run_for or DEFAULT_HEADLESS_RUN
+    watch = Stopwatch.StartNew()
+    monitor.Parse('emulation RunFor "%s"' % seconds)
+    watch.Stop()
+    print("%s: %.3f host s for %s simulated s" %
+          ("headless" if flag(headless) else "with analyzers", watch.Elapsed.TotalSeconds, seconds))
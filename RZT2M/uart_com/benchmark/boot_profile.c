@@ -0,0 +1,70 @@
+// boot_profile.c - prints, on SCI1, the RAM footprint of the image and the time from reset
+// to main(). Built by the Makefile as the RAM image and as the XIP flash image:
+//   ... -T ../../linker_rzt2m.ld     -o boot_profile_ram.elf
+//   ... -T ../../linker_rzt2m_xip.ld -o boot_profile_xip.elf
+//   objcopy -O binary boot_profile_xip.elf boot_profile_xip.bin
+// The time comes from CNTPCT, which counts from reset, so it covers the startup's
+// copies of the TCM and .data images (none for the RAM image).
+#include "../../sci_driver.h"
+#include "../../rzt2m_timer.h"
+
+#define UART0_BASE 0x80001000UL  // SCI0, interrupt-driven like the other firmware
+#define UART1_BASE 0x80001400UL  // SCI1, report
+
+#define SRAM_BASE  0x10000000u
+
+// linker script symbols
+extern char _tcm_start[], _tcm_end[], _end[];
+
+// initialised data, copied out of flash by the XIP startup
+static char greeting[] = "Hello from the boot profile\n";
+
+static void put_u32(uint32_t base, uint32_t value)
+{
+    char digits[11];
+    int n = 0;
+    do {
+        digits[n++] = (char)('0' + value % 10u);
+        value /= 10u;
+    } while(value);
+    while(n) uart_putc(base, digits[--n]);
+}
+
+static void report(const char* name, uint32_t value, const char* unit)
+{
+    uart_puts(UART1_BASE, name);
+    uart_puts(UART1_BASE, ": ");
+    put_u32(UART1_BASE, value);
+    uart_puts(UART1_BASE, unit);
+}
+
+int main(void)
+{
+    uint64_t boot_ticks = timer_now();
+
+    timer_init();
+    irq_init();
+    uart_init(UART0_BASE);
+    uart_init(UART1_BASE);
+    uart_enable_irq(UART0_BASE);
+
+    // code running from flash means an XIP image
+    uart_puts(UART1_BASE, (uint32_t)main >= 0x88000000u ? "image xip\n" : "image ram\n");
+    report("sram", (uint32_t)_end - SRAM_BASE, " bytes (code, data, bss; stack not counted)\n");
+    report("atcm", (uint32_t)(_tcm_end - _tcm_start), " bytes\n");
+    // a boot takes far less than the 214 s a 32-bit count covers; a 32-bit division
+    // stays a UDIV instead of a libgcc call
+    report("boot-to-main", (uint32_t)boot_ticks / (TIMER_HZ / 1000000u), " us\n");
+
+    uart_puts(UART0_BASE, greeting);
+    uart_flush(UART0_BASE);
+    uart_puts(UART1_BASE, "done\n");
+    while (1) cpu_idle();
+    return 0;
+}
+
+void _exit(int status)
+{
+    (void)status;
+    while (1) { }
+}
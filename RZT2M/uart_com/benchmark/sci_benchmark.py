@@ -0,0 +1,125 @@
+# Helpers for the RZ/T2M SCI benchmarks.
+# Load with `include @.../sci_benchmark.py`, every `mc_*` function becomes a monitor command.
+
+from System import Action
+from System.Diagnostics import Stopwatch
+from Antmicro.Renode.Time import TimeInterval
+
+SCI_RDR  = 0x00
+SCI_TDR  = 0x04
+SCI_CCR0 = 0x08
+SCI_FCR  = 0x24
+SCI_FRSR = 0x50
+
+CCR0_RE  = 1 << 0
+CCR0_TE  = 1 << 4
+CCR0_RIE = 1 << 16
+
+MEGABYTE = 1024 * 1024
+
+def sci_rx_level(sci):
+    return (sci.ReadDoubleWord(SCI_FRSR) >> 8) & 0x3F
+
+def sci_drain(sci):
+    # what a guest RXI handler does: read everything that is in the fifo
+    level = sci_rx_level(sci)
+    for _ in range(level):
+        sci.ReadDoubleWord(SCI_RDR)
+    return level
+
+def sci_setup(name, triggerLevelMode, rtrg):
+    sci = monitor.Machine[name]
+    sci.Reset()
+    sci.RxTriggerLevelMode = triggerLevelMode
+    sci.WriteDoubleWord(SCI_FCR, (sci.ReadDoubleWord(SCI_FCR) & 0xFFE0FFFF) | (rtrg << 16))
+    sci.WriteDoubleWord(SCI_CCR0, CCR0_RE | CCR0_TE | CCR0_RIE)
+    return sci
+
+def mc_sci_rx_benchmark(mode, megabytes=1, burst=64, rtrg=8):
+    """sci_rx_benchmark per-char|trigger-level [megabytes] [burst] [rtrg]"""
+    megabytes = int(str(megabytes))
+    burst = int(str(burst))
+    rtrg = int(str(rtrg))
+    machine = monitor.Machine
+    sci = sci_setup("sysbus.sci0", str(mode) == "trigger-level", rtrg)
+
+    total = megabytes * MEGABYTE
+    state = {"sent": 0, "received": 0}
+
+    def send_burst(_):
+        # an RXI raised by the receive timeout during the idle gap is served first
+        if sci.RxIRQ.IsSet:
+            state["received"] += sci_drain(sci)
+        sent = state["sent"]
+        for i in range(min(burst, total - sent)):
+            sci.WriteChar(0x20 + (sent + i) % 0x5F)
+            if sci.RxIRQ.IsSet:
+                state["received"] += sci_drain(sci)
+        state["sent"] = sent + burst
+        # line goes idle between bursts, long enough for the receive timeout to expire
+        if state["sent"] < total:
+            machine.ScheduleAction(TimeInterval.FromMilliseconds(1), Action[TimeInterval](send_burst))
+
+    bursts = (total + burst - 1) // burst
+    machine.ScheduleAction(TimeInterval.FromMilliseconds(1), Action[TimeInterval](send_burst))
+    watch = Stopwatch.StartNew()
+    monitor.Parse('emulation RunFor "%.3f"' % ((bursts + 2) * 0.001))
+    watch.Stop()
+    if sci.RxIRQ.IsSet:
+        state["received"] += sci_drain(sci)
+
+    irqs = sci.ReceiveInterruptCount
+    print("sci0 RX [%s]: %d/%d bytes drained, %d RXI assertions (%.1f per MB), %.3f host s per MB" %
+          (mode, state["received"], total, irqs, float(irqs) / megabytes, watch.Elapsed.TotalSeconds / megabytes))
+
+def mc_sci_ingest_benchmark(mode, megabytes=1, block=16):
+    """sci_ingest_benchmark per-byte|block [megabytes] [block]"""
+    from System import Array, Byte
+    megabytes = int(str(megabytes))
+    block = int(str(block))
+    sci = sci_setup("sysbus.sci0", False, 1)
+
+    data = Array.CreateInstance(Byte, block)
+    for i in range(block):
+        data[i] = 0x20 + i % 0x5F
+
+    total = megabytes * MEGABYTE
+    watch = Stopwatch.StartNew()
+    for _ in range(total // block):
+        if str(mode) == "block":
+            sci.WriteChars(data)
+        else:
+            for b in data:
+                sci.WriteChar(b)
+        sci_drain(sci)
+    watch.Stop()
+
+    print("sci0 ingest [%s]: %d bytes in blocks of %d, %.3f host s per MB" %
+          (mode, total, block, watch.Elapsed.TotalSeconds / megabytes))
+
+def sci_echo(sci, count):
+    # every byte is received and sent back, so both capture directions are exercised
+    for i in range(count):
+        sci.WriteChar(0x20 + i % 0x5F)
+        sci.WriteDoubleWord(SCI_TDR, sci.ReadDoubleWord(SCI_RDR) & 0xFF)
+
+def mc_sci_capture_benchmark(path, kilobytes=256):
+    """sci_capture_benchmark capture_path [kilobytes] - echo workload on sci0 without and with StartCapture"""
+    count = int(str(kilobytes)) * 1024
+    sci = sci_setup("sysbus.sci0", False, 1)
+
+    watch = Stopwatch.StartNew()
+    sci_echo(sci, count)
+    watch.Stop()
+    plain = watch.Elapsed.TotalSeconds
+
+    monitor.Parse('sysbus.sci0 StartCapture @%s' % str(path).lstrip('@'))
+    watch = Stopwatch.StartNew()
+    sci_echo(sci, count)
+    watch.Stop()
+    monitor.Parse('sysbus.sci0 StopCapture')
+    captured = watch.Elapsed.TotalSeconds
+
+    # worst case: nothing but UART traffic, no guest code in between
+    print("sci0 capture: %d bytes echoed (%d records), %.3f host s plain, %.3f host s captured, %.1f%% overhead, %.0f ns per record" %
+          (count, 2 * count, plain, captured, 100.0 * (captured - plain) / plain, (captured - plain) * 1e9 / (2 * count)))
@@ -0,0 +1,36 @@
+// ring_forward.c - ring node: forwards every byte from the left neighbour (SCI1) to the right one (SCI0)
+#include "../../sci_driver.h"
+
+#define UART0_BASE 0x80001000UL  // SCI0, to the right neighbour
+#define UART1_BASE 0x80001400UL  // SCI1, from the left neighbour
+
+// per-hop work, so every machine has something to execute between bytes
+#define HOP_WORK   2000
+
+static void hop_work(volatile int count)
+{
+    while(count--);
+}
+
+int main(void)
+{
+    // interrupt-driven: waiting for the left neighbour sleeps in WFI
+    uart_init(UART0_BASE);
+    uart_init(UART1_BASE);
+    uart_enable_irq(UART0_BASE);
+    uart_enable_irq(UART1_BASE);
+    irq_init();
+
+    while (1) {
+        char c = uart_getc(UART1_BASE);
+        hop_work(HOP_WORK);
+        uart_putc(UART0_BASE, c);
+    }
+    return 0;
+}
+
+void _exit(int status)
+{
+    (void)status;
+    while (1) { }
+}
@@ -0,0 +1,44 @@
+// ring_origin.c - first ring node: puts TOKENS bytes on the ring, then forwards like ring_forward.c
+// with every byte that made it round incremented
+#include "../../sci_driver.h"
+#include "../../rzt2m_timer.h"
+
+#define UART0_BASE 0x80001000UL  // SCI0, to the right neighbour
+#define UART1_BASE 0x80001400UL  // SCI1, from the left neighbour
+
+// per-hop work, so every machine has something to execute between bytes
+#define HOP_WORK   2000
+// bytes circulating at the same time
+#define TOKENS     4
+
+static void hop_work(volatile int count)
+{
+    while(count--);
+}
+
+int main(void)
+{
+    timer_init();
+    // interrupt-driven: waiting for the left neighbour sleeps in WFI
+    uart_init(UART0_BASE);
+    uart_init(UART1_BASE);
+    uart_enable_irq(UART0_BASE);
+    uart_enable_irq(UART1_BASE);
+    irq_init();
+
+    sleep_ms(1); // let the other nodes boot
+    for (int i = 0; i < TOKENS; ++i)
+        uart_putc(UART0_BASE, (char)('A' + i));
+    while (1) {
+        char c = uart_getc(UART1_BASE);
+        hop_work(HOP_WORK);
+        uart_putc(UART0_BASE, (char)(c + 1));
+    }
+    return 0;
+}
+
+void _exit(int status)
+{
+    (void)status;
+    while (1) { }
+}
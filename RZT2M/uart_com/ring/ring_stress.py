@@ -0,0 +1,65 @@
+# RZ/T2M SCI ring stress scenario: N machines, node i SCI0 -> node i+1 SCI1, one UARTHub per link.
+# Load with `include @.../ring_stress.py`, every `mc_*` function becomes a monitor command.
+#
+# Machines run on their own host threads unless serial execution is requested; bytes
+# crossing a hub are delivered at synchronisation points, in the same order on every
+# run. Each configuration is run twice and the byte trace seen by node0 is compared.
+
+from System.Diagnostics import Stopwatch
+
+def run(command):
+    monitor.Parse(command)
+
+def path(token):
+    value = str(token)
+    return value if value.startswith("@") else "@" + value
+
+def build_ring(count, platform, origin_elf, forward_elf):
+    for i in range(count):
+        run('mach create "node%d"' % i)
+        run('mach set "node%d"' % i)
+        run('machine LoadPlatformDescription %s' % platform)
+        run('sysbus LoadELF %s' % (origin_elf if i == 0 else forward_elf))
+        # UARTHub delivers whole lines at once, more than the 16-stage fifo holds
+        run('sysbus.sci0 ReceiveFifoCapacity 256')
+        run('sysbus.sci1 ReceiveFifoCapacity 256')
+    for i in range(count):
+        run('emulation CreateUARTHub "ring%d"' % i)
+        run('mach set "node%d"' % i)
+        run('connector Connect sysbus.sci0 "ring%d"' % i)
+        run('mach set "node%d"' % ((i + 1) % count))
+        run('connector Connect sysbus.sci1 "ring%d"' % i)
+
+def run_ring(count, serial, seconds, platform, origin_elf, forward_elf):
+    build_ring(count, platform, origin_elf, forward_elf)
+    run('emulation SetGlobalSerialExecution %s' % ("true" if serial else "false"))
+
+    # every byte node0 puts on the ring, with the virtual time it left
+    run('mach set "node0"')
+    origin = monitor.Machine
+    trace = []
+    def on_char(c):
+        trace.append((origin.ElapsedVirtualTime.TimeElapsed.Ticks, c))
+    origin["sysbus.sci0"].CharReceived += on_char
+
+    watch = Stopwatch.StartNew()
+    run('emulation RunFor "%s"' % seconds)
+    watch.Stop()
+
+    origin["sysbus.sci0"].CharReceived -= on_char
+    run('Clear')
+    return watch.Elapsed.TotalSeconds, trace
+
+def mc_ring_stress(platform, origin_elf, forward_elf, first=8, last=16, step=4, seconds=1):
+    """ring_stress platform origin_elf forward_elf [first N] [last N] [step] [virtual seconds]"""
+    platform, origin_elf, forward_elf = path(platform), path(origin_elf), path(forward_elf)
+    seconds = str(seconds)
+    print("machines  mode      host s/sim s  machine-s/host s  bytes  deterministic")
+    for count in range(int(str(first)), int(str(last)) + 1, int(str(step))):
+        for serial in (True, False):
+            host, trace = run_ring(count, serial, seconds, platform, origin_elf, forward_elf)
+            _, again = run_ring(count, serial, seconds, platform, origin_elf, forward_elf)
+            simulated = float(seconds)
+            print("%8d  %-8s  %12.3f  %16.3f  %5d  %s" %
+                  (count, "serial" if serial else "parallel", host / simulated,
+                   count * simulated / host, len(trace), "yes" if trace == again else "NO"))
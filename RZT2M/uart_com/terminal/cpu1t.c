@@ -1,103 +1,28 @@
-#ifndef _STDINT_H
-#define _STDINT_H
-
-typedef unsigned char      uint8_t;
-typedef unsigned short     uint16_t;
-typedef unsigned int       uint32_t;
-typedef unsigned long long uint64_t;
-
-typedef signed char        int8_t;
-typedef signed short       int16_t;
-typedef signed int         int32_t;
-typedef signed long long   int64_t;
-
-#endif /* _STDINT_H */
+#include "../../sci_driver.h"
+#include "../../rzt2m_timer.h"
 
 #define UART0_BASE 0x80001000UL  // SCI0 (communication)
 #define UART1_BASE 0x80001400UL  // SCI1 (debug)
 
-#define UART_DR    0x00
-#define UART_TDR   0x04
-#define UART_FR    0x18
-#define UART_IBRD  0x24
-#define UART_FBRD  0x28
-#define UART_LCRH  0x2C
-#define UART_CR    0x30
-#define UART_FRSR  0x50  // FIFOReceiveStatus (Renesas SCI): bit0=DR (data ready)
-
-#define FR_TXFF    (1 << 5)
-#define CR_UARTEN  (1 << 0)
-#define CR_TXE     (1 << 8)
-#define CR_RXE     (1 << 9)
-#define LCRH_WLEN_8 (3 << 5)
-#define LCRH_FEN    (1 << 4)
-
-static void uart_init(uint32_t base)
-{
-    *(volatile uint32_t*)(base + UART_CR) = 0x0;
-    *(volatile uint32_t*)(base + UART_IBRD) = 1;
-    *(volatile uint32_t*)(base + UART_FBRD) = 0;
-    *(volatile uint32_t*)(base + UART_LCRH) = LCRH_WLEN_8 | LCRH_FEN;
-    *(volatile uint32_t*)(base + UART_CR) = CR_UARTEN | CR_TXE | CR_RXE;
-}
-
-static void uart_putc(uint32_t base, char c)
-{
-    while (*(volatile uint32_t*)(base + UART_FR) & FR_TXFF);
-    *(volatile uint32_t*)(base + UART_TDR) = (uint32_t)c;
-}
-
-static void uart_puts(uint32_t base, const char *s)
-{
-    while (*s) {
-        if (*s == '\n') uart_putc(base, '\r');
-        uart_putc(base, *s++);
-    }
-}
-
-static void delay(volatile int count)
-{
-    while(count--);
-}
-
-static char uart_getc(uint32_t base)
-{
-    while((*(volatile uint32_t*)(base + UART_FRSR) & 0x1u) == 0u) { }
-    return (char)(*(volatile uint32_t*)(base + UART_DR) & 0xFF);
-}
-
-static int uart_readline(uint32_t base, char* buf, int max)
-{
-    int i = 0;
-    char c;
-    while(i < max - 1) {
-        c = uart_getc(base);
-        if(c == '\r') continue;
-        if(c == '\n') break;
-        buf[i++] = c;
-    }
-    buf[i] = '\0';
-    return i;
-}
-
-static void flush_rx_until_idle(uint32_t base, int idleIterations)
+// drops received bytes until the line has been quiet for idle_us; sleeps through each
+// window, the RXI handler collects whatever arrives meanwhile
+static void flush_rx_until_idle(uint32_t base, uint32_t idle_us)
 {
-    int idle = 0;
-    while(idle < idleIterations) {
-        if((*(volatile uint32_t*)(base + UART_FRSR) & 0x1u) != 0u) {
-            (void)(*(volatile uint32_t*)(base + UART_DR)); // drop pending byte
-            idle = 0;
-        } else {
-            idle++;
+    int dropped;
+    do {
+        sleep_us(idle_us);
+        dropped = 0;
+        while(uart_try_getc(base) >= 0) { // drop pending bytes
+            dropped = 1;
         }
-    }
+    } while(dropped);
 }
 
 static int strlen_c(const char* s) { int n=0; while(s && *s++) n++; return n; }
 
-static void echo_debug_input_after_delay(uint32_t base, uint32_t delay_cycles)
+static void echo_debug_input_after_delay(uint32_t base, uint32_t delay_ms)
 {
-    volatile uint32_t d = delay_cycles; while(d--) { }
+    sleep_ms(delay_ms);
 
     char line[128];
     int idx = 0;
@@ -106,18 +31,12 @@ static void echo_debug_input_after_delay(uint32_t base, uint32_t delay_cycles)
 
     for(;;)
     {
-        if(drop_remaining > 0 && ((*(volatile uint32_t*)(base + UART_FRSR) & 0x1u) != 0u)) {
-            (void)(*(volatile uint32_t*)(base + UART_DR));
+        char c = uart_getc(base); // sleeps in WFI until the RXI handler has a byte
+        if(drop_remaining > 0) {
             drop_remaining--;
             continue;
         }
 
-        if((*(volatile uint32_t*)(base + UART_FRSR) & 0x1u) == 0u) {
-            continue;
-        }
-
-        char c = (char)(*(volatile uint32_t*)(base + UART_DR) & 0xFF);
-
         if(c == '\r' || c == '\n')
         {
             if(lastWasCR && (c == '\n')) { lastWasCR = 0; continue; }
@@ -142,9 +61,14 @@ static void echo_debug_input_after_delay(uint32_t base, uint32_t delay_cycles)
 
 int main(void)
 {
+    timer_init();
     uart_init(UART0_BASE); // Communication UART
     uart_init(UART1_BASE); // Debug UART
-    delay(10000); // fast delay for Renode
+    // interrupt-driven: waiting for the peer or the terminal sleeps in WFI
+    uart_enable_irq(UART0_BASE);
+    uart_enable_irq(UART1_BASE);
+    irq_init();
+    sleep_ms(1);
 
     // Receive from CPU0 on SCI0
     char msg[64];
@@ -160,12 +84,13 @@ int main(void)
     uart_puts(UART0_BASE, "Hello from CPU1 to CPU0!\n");
 
     // Flush any looped-back SCI1 TX before starting echo
-    flush_rx_until_idle(UART1_BASE, 2000);
+    flush_rx_until_idle(UART1_BASE, 200u);
 
     // Start echoing terminal input after ~1s (tune the count for your setup)
-    echo_debug_input_after_delay(UART1_BASE, 20000000u);
+    echo_debug_input_after_delay(UART1_BASE, 1000u);
 
     // unreachable
+    return 0;
 }
 
 void _exit(int status)
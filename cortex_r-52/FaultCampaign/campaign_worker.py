@@ -0,0 +1,36 @@
+# Renode side of fault_campaign.py. Load with `include @.../campaign_worker.py`;
+# `fault_worker` then runs a slice of the fault plan, every run starting from the warm-up snapshot.
+#
+# Plan lines (CSV, no header): run id, kind, address (dram0 offset), argument
+#   kind "none":   no injection (golden run)
+#   kind "write":  32-bit write of argument
+#   kind "bitflip": flip bit `argument` of the 32-bit word
+
+import os
+from System.Diagnostics import Stopwatch
+
+def inject(dram, kind, address, argument):
+    if kind == "write":
+        dram.WriteDoubleWord(address, argument & 0xFFFFFFFF)
+    elif kind == "bitflip":
+        dram.WriteDoubleWord(address, dram.ReadDoubleWord(address) ^ (1 << argument))
+
+def mc_fault_worker(snapshot, plan, out_dir, window="1"):
+    """fault_worker snapshot plan.csv out_dir [window s]"""
+    snapshot = str(snapshot).lstrip("@")
+    out_dir = str(out_dir).lstrip("@")
+    window = str(window)
+    with open(str(plan).lstrip("@")) as f:
+        runs = [line.strip().split(",") for line in f if line.strip()]
+
+    watch = Stopwatch.StartNew()
+    for run_id, kind, address, argument in runs:
+        monitor.Parse('Load @%s' % snapshot)
+        monitor.Parse('mach set "R52"')
+        log = os.path.join(out_dir, "run_%s.log" % run_id)
+        monitor.Parse('uart0 CreateFileBackend @%s true' % log)
+        inject(monitor.Machine["sysbus.dram0"], kind, int(address, 0), int(argument, 0))
+        monitor.Parse('emulation RunFor "%s"' % window)
+        monitor.Parse('uart0 CloseFileBackend @%s' % log)
+    watch.Stop()
+    print("fault_worker: %d runs, %.3f host s" % (len(runs), watch.Elapsed.TotalSeconds))
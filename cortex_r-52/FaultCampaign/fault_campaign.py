@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+"""Fault-injection campaign for the Cortex-R52 memory scenarios.
+
+Boots the firmware once (fault_warmup.resc saves a snapshot after the warm-up
+interval), then forks every fault run from that snapshot. Runs are split across
+--jobs Renode processes, each loading the snapshot before every injection, so the
+campaign costs one boot plus the post-injection windows. Run 0 injects nothing
+and is the golden reference the other runs' UART output is compared with.
+
+usage: fault_campaign.py --renode renode --faults 1000 --jobs 8 [--out campaign]
+"""
+
+import argparse
+import csv
+import os
+import random
+import subprocess
+import sys
+import time
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+
+def make_plan(count, base, size, seed):
+    rng = random.Random(seed)
+    plan = [(0, "none", 0, 0)]
+    for run in range(1, count + 1):
+        address = base + rng.randrange(0, size, 4)
+        if rng.random() < 0.5:
+            plan.append((run, "bitflip", address, rng.randrange(32)))
+        else:
+            plan.append((run, "write", address, rng.choice([0xDEADBEEF, 0x0, 0xFFFFFFFF, rng.getrandbits(32)])))
+    return plan
+
+
+def renode(binary, script, variables):
+    # variables go in front of the script, the same way `$var?=` defaults are overridden
+    commands = ["$%s=%s" % (name, value) for name, value in variables.items()]
+    commands += ["include @%s" % script, "quit"]
+    args = [binary, "--disable-xwt", "--console", "--hide-log", "--plain"]
+    for command in commands:
+        args += ["-e", command]
+    return subprocess.Popen(args, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--renode", default="renode")
+    parser.add_argument("--elf", default=os.path.join(HERE, "..", "MemoryWatch", "uart_memwatch.elf"))
+    parser.add_argument("--warmup", default="1", help="virtual seconds before the snapshot")
+    parser.add_argument("--window", default="1", help="virtual seconds run after each injection")
+    parser.add_argument("--faults", type=int, default=100)
+    parser.add_argument("--base", type=lambda v: int(v, 0), default=0x0, help="first dram0 offset to target")
+    parser.add_argument("--size", type=lambda v: int(v, 0), default=0x10000, help="size of the targeted range")
+    parser.add_argument("--jobs", type=int, default=os.cpu_count() or 1)
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--out", default="campaign")
+    args = parser.parse_args()
+
+    out = os.path.abspath(args.out)
+    os.makedirs(out, exist_ok=True)
+    snapshot = os.path.join(out, "warmup.save")
+
+    started = time.time()
+    boot = renode(args.renode, os.path.join(HERE, "fault_warmup.resc"),
+                  {"bin": "@" + os.path.abspath(args.elf), "warmup": '"%s"' % args.warmup, "snapshot": "@" + snapshot})
+    boot.communicate()
+    if boot.returncode != 0 or not os.path.exists(snapshot):
+        sys.exit("warm-up failed, no snapshot written")
+    booted = time.time()
+
+    plan = make_plan(args.faults, args.base, args.size, args.seed)
+    workers = []
+    for job in range(args.jobs):
+        part = plan[job::args.jobs]
+        if not part:
+            continue
+        plan_file = os.path.join(out, "plan_%d.csv" % job)
+        with open(plan_file, "w") as f:
+            for run, kind, address, argument in part:
+                f.write("%d,%s,0x%X,0x%X\n" % (run, kind, address, argument))
+        script = os.path.join(out, "worker_%d.resc" % job)
+        with open(script, "w") as f:
+            f.write("include @%s\n" % os.path.join(HERE, "campaign_worker.py"))
+            f.write('fault_worker @%s @%s @%s "%s"\n' % (snapshot, plan_file, out, args.window))
+        workers.append(renode(args.renode, script, {}))
+    for worker in workers:
+        worker.communicate()
+    finished = time.time()
+
+    def output(run):
+        path = os.path.join(out, "run_%d.log" % run)
+        return open(path, errors="replace").read() if os.path.exists(path) else None
+
+    golden = output(0)
+    with open(os.path.join(out, "summary.csv"), "w", newline="") as f:
+        writer = csv.writer(f)
+        writer.writerow(["run", "kind", "address", "argument", "outcome"])
+        outcomes = {}
+        for run, kind, address, argument in plan:
+            text = output(run)
+            outcome = "missing" if text is None else ("masked" if text == golden else "visible")
+            outcomes[outcome] = outcomes.get(outcome, 0) + 1
+            writer.writerow([run, kind, "0x%X" % address, "0x%X" % argument, outcome])
+
+    print("boot + warm-up: %.1f s, %d runs on %d jobs: %.1f s" %
+          (booted - started, len(plan), len(workers), finished - booted))
+    print("outcomes: " + ", ".join("%s %d" % item for item in sorted(outcomes.items())))
+    print("per-run results in %s" % os.path.join(out, "summary.csv"))
+
+
+if __name__ == "__main__":
+    main()